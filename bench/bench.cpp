@@ -0,0 +1,269 @@
+/**
+ ******************************************************************************
+ * @file        : bench.cpp
+ * @brief       : Codec micro-benchmarks
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Host benchmark of the codecs: the downlink decoder (Payload), the
+ * telemetry encoder and the batch decoder of the backend. Their behavior is
+ * tested in test/test_codec.
+ *
+ * Usage: program [BASELINE [TOLERANCE]]
+ * Prints the host and the compiler, one "name ns/op" line per benchmark,
+ * then one "name bytes" line per codec with the size of its code in this
+ * program, read from its symbol table with nm. With a baseline (a previous
+ * output), the run fails if a benchmark is more than TOLERANCE (default
+ * kTolerance) slower, or if a codec is more than kSizeTolerance larger.
+ * Timings are only compared on the host of the baseline, and code sizes
+ * with its compiler.
+ ******************************************************************************
+ */
+
+#include <Arduino.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "payload.hpp"
+#include "telemetry.hpp"
+#include "telemetry_batch.hpp"
+
+static const double kTolerance     = 1.25;
+static const double kSizeTolerance = 1.05;
+static const double kMinDuration   = 0.05;  // seconds per measurement
+static const int kRuns             = 5;     // the fastest one is kept
+static const int kBatchSize        = 256;   // frames per batch
+
+using Bytes = std::vector<uint8_t>;
+
+// ---------------------------------------------------------------------------
+// Benchmarks
+// ---------------------------------------------------------------------------
+
+static volatile uint32_t sink;  // NOLINT(*-global-variables)
+
+template <typename F>
+static double Measure(F body) {
+    using Clock = std::chrono::steady_clock;
+    double best = 1e300;  // NOLINT
+    for (int run = 0; run < kRuns; run++) {
+        long iterations = 0;
+        double elapsed  = 0;
+        auto start      = Clock::now();
+        for (long batch = 1; elapsed < kMinDuration; batch *= 2) {
+            for (long i = 0; i < batch; i++) {
+                body();
+            }
+            iterations += batch;
+            elapsed =
+                std::chrono::duration<double>(Clock::now() - start).count();
+        }
+        best = min(best, elapsed * 1e9 / iterations);  // NOLINT
+    }
+    return best;
+}
+
+static uint32_t Decode(const Bytes& frame) {
+    Payload payload(frame.data(), frame.size());
+    Command c;
+    uint32_t sum = 0;
+    while (payload.Next(&c)) {
+        sum += c.opcode + c.valve + c.value;
+    }
+    return sum;
+}
+
+struct Result {
+    const char* name;
+    double ns;
+};
+
+static std::vector<Result> Benchmark() {
+    std::vector<Result> results;
+    Bytes legacy = {0x12, 0xEF, 0x30};
+    uint8_t buffer[32];  // NOLINT
+    DownlinkWriter writer(buffer, sizeof(buffer));
+    writer.Open(2, 600);  // NOLINT
+    writer.Close(3);      // NOLINT
+    writer.Query(1);
+    Bytes tlv(buffer, buffer + writer.Length());
+    Bytes truncated(tlv.begin(), tlv.end() - 1);
+    results.push_back(
+        {"decode_legacy", Measure([&] { sink = Decode(legacy); })});
+    results.push_back({"decode_tlv", Measure([&] { sink = Decode(tlv); })});
+    results.push_back(
+        {"decode_truncated", Measure([&] { sink = Decode(truncated); })});
+
+    Telemetry telemetry(32);  // NOLINT
+    for (int i = 0; i < Telemetry::kCapacity; i++) {
+        if (i % 4 == 0) {
+            telemetry.AddEvent(i * 60, Telemetry::kOpened, i % 32);  // NOLINT
+        } else {
+            telemetry.AddSample(i * 60, 3900 - i, 1UL << (i % 32));  // NOLINT
+        }
+    }
+    uint8_t frame[222];  // NOLINT
+    results.push_back({"encode_telemetry_51", Measure([&] {
+                           sink = telemetry.Encode(4000, frame, 51);  // NOLINT
+                       })});
+    results.push_back({"encode_telemetry_222", Measure([&] {
+                           sink = telemetry.Encode(4000, frame, 222);  // NOLINT
+                       })});
+
+    // Throughput of the backend, per frame
+    int len = telemetry.Encode(4000, frame, sizeof(frame));  // NOLINT
+    std::vector<TelemetryFrame> batch(kBatchSize, {frame, len});
+    TelemetryColumns columns;
+    double ns = Measure([&] {
+        columns.Clear();
+        sink = DecodeTelemetry(batch.data(), kBatchSize, &columns);
+    });
+    results.push_back({"batch_telemetry_222", ns / kBatchSize});
+    return results;
+}
+
+// Code of a codec: the functions whose demangled name starts with `prefix`
+struct Size {
+    const char* name;
+    const char* prefix;
+    long bytes;
+};
+
+static std::vector<Size> CodeSize() {
+    std::vector<Size> sizes = {{"size_payload", "Payload::", 0},
+                               {"size_telemetry", "Telemetry::", 0},
+                               {"size_batch_telemetry", "DecodeTelemetry(", 0}};
+    char command[64];  // NOLINT
+    snprintf(command, sizeof(command), "nm -C -S /proc/%d/exe 2>/dev/null",
+             static_cast<int>(getpid()));
+    FILE* nm = popen(command, "r");
+    if (nm == nullptr) {
+        return {};
+    }
+    std::set<unsigned long> seen;  // constructors are aliased
+    bool found = false;
+    char line[4096];  // NOLINT
+    while (fgets(line, sizeof(line), nm) != nullptr) {
+        unsigned long address;
+        unsigned long size;
+        char type;
+        int name;
+        if (sscanf(line, "%lx %lx %c %n", &address, &size, &type, &name) != 3 ||
+            (type != 'T' && type != 't') || !seen.insert(address).second) {
+            continue;
+        }
+        for (Size& s : sizes) {
+            if (strncmp(line + name, s.prefix, strlen(s.prefix)) == 0) {
+                s.bytes += size;
+                found = true;
+            }
+        }
+    }
+    pclose(nm);
+    if (!found) {
+        fprintf(stderr, "no symbol table, code size not measured\n");
+        return {};
+    }
+    return sizes;
+}
+
+// Host and compiler of this run, without spaces
+static std::string Host() {
+    char name[64] = {};  // NOLINT
+    gethostname(name, sizeof(name) - 1);
+    return name;
+}
+
+static std::string Compiler() {
+#if defined(__clang__)
+    std::string compiler = "clang-" __VERSION__;
+#else
+    std::string compiler = "gcc-" __VERSION__;
+#endif
+    for (char& c : compiler) {
+        c = c == ' ' ? '_' : c;
+    }
+    return compiler;
+}
+
+static int Compare(const char* path,
+                   double tolerance,
+                   const std::vector<Result>& results,
+                   const std::vector<Size>& sizes) {
+    FILE* file = fopen(path, "r");
+    if (file == nullptr) {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return 2;
+    }
+    bool sameHost     = false;
+    bool sameCompiler = false;
+    int worse         = 0;
+    char line[256];  // NOLINT
+    while (fgets(line, sizeof(line), file) != nullptr) {
+        char name[128];  // NOLINT
+        double value;
+        char unit[16];  // NOLINT
+        if (sscanf(line, "host %127s", name) == 1) {
+            sameHost = Host() == name;
+        } else if (sscanf(line, "compiler %127s", name) == 1) {
+            sameCompiler = Compiler() == name;
+        } else if (sscanf(line, "%127s %lf %15s", name, &value, unit) != 3) {
+            continue;
+        } else if (strcmp(unit, "bytes") == 0) {
+            for (const Size& size : sizes) {
+                if (sameCompiler && strcmp(size.name, name) == 0 &&
+                    size.bytes > value * kSizeTolerance) {
+                    fprintf(stderr, "%s: %ld bytes, baseline %.0f\n", name,
+                            size.bytes, value);
+                    worse++;
+                }
+            }
+        } else {
+            for (const Result& result : results) {
+                if (sameHost && strcmp(result.name, name) == 0 &&
+                    result.ns > value * tolerance) {
+                    fprintf(stderr, "%s: %.1f ns/op, baseline %.1f\n", name,
+                            result.ns, value);
+                    worse++;
+                }
+            }
+        }
+    }
+    fclose(file);
+    if (!sameHost) {
+        fprintf(stderr, "%s: other host, timings not compared\n", path);
+    }
+    if (!sameCompiler) {
+        fprintf(stderr, "%s: other compiler, sizes not compared\n", path);
+    }
+    return worse > 0 ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    double tolerance = argc == 3 ? atof(argv[2]) : kTolerance;
+    if (argc > 3 || tolerance < 1) {
+        fprintf(stderr, "usage: %s [BASELINE [TOLERANCE]]\n", argv[0]);
+        return 2;
+    }
+    printf("host %s\n", Host().c_str());
+    printf("compiler %s\n", Compiler().c_str());
+    std::vector<Result> results = Benchmark();
+    for (const Result& result : results) {
+        printf("%-24s %10.1f ns/op\n", result.name, result.ns);
+    }
+    std::vector<Size> sizes = CodeSize();
+    for (const Size& size : sizes) {
+        printf("%-24s %10ld bytes\n", size.name, size.bytes);
+    }
+    return argc >= 2 ? Compare(argv[1], tolerance, results, sizes) : 0;
+}
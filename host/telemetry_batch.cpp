@@ -0,0 +1,103 @@
+/**
+ ******************************************************************************
+ * @file        : telemetry_batch.cpp
+ * @brief       : Batch decoder of telemetry frames
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * The bit stream is variable length, so the records are decoded one after
+ * the other into the scalar columns. The valve bitmasks are expanded in a
+ * second pass, with no data dependency between records: 8 valves at a time,
+ * with 64-bit arithmetic (SIMD within a register).
+ ******************************************************************************
+ */
+
+#include "telemetry_batch.hpp"
+
+#include <string.h>
+
+void TelemetryColumns::Clear() {
+    frame.clear();
+    time.clear();
+    kind.clear();
+    millivolts.clear();
+    valve.clear();
+    valves.clear();
+    open.clear();
+}
+
+// Byte i of the result is bit i of `bits`, as 0 or 1
+static inline uint64_t Spread(uint32_t bits) {
+    const uint64_t kOnes = 0x0101010101010101ULL;
+    const uint64_t kMask = 0x8040201008040201ULL;  // bit i in byte i
+    const uint64_t kLow  = 0x7F7F7F7F7F7F7F7FULL;
+    uint64_t x           = (bits & 0xFF) * kOnes & kMask;  // NOLINT
+    return ((x + kLow) >> 7) & kOnes;  // 1 where the byte is not 0 - NOLINT
+}
+
+static void Expand(const uint32_t* valves, size_t n, uint8_t* open) {
+    const int kBytes = TelemetryColumns::kMaxValves / 8;  // NOLINT
+    for (size_t r = 0; r < n; r++) {
+        for (int b = 0; b < kBytes; b++) {
+            uint64_t bytes = Spread(valves[r] >> (8 * b));  // NOLINT
+            memcpy(open + (r * kBytes + b) * 8, &bytes, 8);  // NOLINT
+        }
+    }
+}
+
+static void Append(TelemetryColumns* columns,
+                   uint32_t frame,
+                   const TelemetryRecord& record,
+                   uint32_t valves) {
+    columns->frame.push_back(frame);
+    columns->time.push_back(record.time);
+    columns->kind.push_back(record.kind);
+    columns->millivolts.push_back(record.millivolts);
+    columns->valve.push_back(record.valve);
+    columns->valves.push_back(valves);
+}
+
+static void Truncate(TelemetryColumns* columns, size_t size) {
+    columns->frame.resize(size);
+    columns->time.resize(size);
+    columns->kind.resize(size);
+    columns->millivolts.resize(size);
+    columns->valve.resize(size);
+    columns->valves.resize(size);
+}
+
+int DecodeTelemetry(const TelemetryFrame* frames,
+                    int n,
+                    TelemetryColumns* columns) {
+    size_t first = columns->Size();
+    int rejected = 0;
+    for (int i = 0; i < n; i++) {
+        TelemetryReader reader(frames[i].data, frames[i].len);
+        size_t start    = columns->Size();
+        uint32_t valves = 0;
+        TelemetryRecord record;
+        while (reader.Next(&record)) {
+            if (record.kind == TelemetryFormat::kSample) {
+                valves = record.valves;
+            }
+            Append(columns, i, record, valves);
+        }
+        if (!reader.IsValid()) {
+            Truncate(columns, start);
+            rejected++;
+        }
+    }
+
+    size_t size = columns->Size();
+    columns->open.resize(size * TelemetryColumns::kMaxValves);
+    Expand(columns->valves.data() + first,
+           size - first,
+           columns->open.data() + first * TelemetryColumns::kMaxValves);
+    return rejected;
+}
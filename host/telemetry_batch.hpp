@@ -0,0 +1,54 @@
+/**
+ ******************************************************************************
+ * @file        : telemetry_batch.hpp
+ * @brief       : Batch decoder of telemetry frames
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Backend side of the telemetry codec: decode many uplinks at once into
+ * columns, one entry per record, ready to be appended to a columnar store.
+ * The valve bitmask is expanded into one byte per valve. Events carry the
+ * valve state of the last sample before them in the same frame.
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "codec.hpp"
+
+struct TelemetryFrame {
+    const uint8_t* data;
+    int len;
+};
+
+struct TelemetryColumns {
+    static const int kMaxValves = TelemetryFormat::kMaxValves;
+
+    std::vector<uint32_t> frame;       // index of the frame in the batch
+    std::vector<uint32_t> time;        // RTC time of the record
+    std::vector<uint8_t> kind;         // TelemetryFormat::Kind
+    std::vector<uint16_t> millivolts;  // samples, 0 for events
+    std::vector<uint8_t> valve;        // events, 0 for samples
+    std::vector<uint32_t> valves;      // bitmask
+    std::vector<uint8_t> open;         // kMaxValves per record, 0 or 1
+
+    size_t Size() const { return time.size(); }
+    void Clear();
+};
+
+// Decode `n` frames and append their records to `columns`. Return the number
+// of frames rejected (bad header or truncated), whose records are dropped.
+int DecodeTelemetry(const TelemetryFrame* frames,
+                    int n,
+                    TelemetryColumns* columns);
@@ -17,11 +17,86 @@
 
 #include "battery.hpp"
 
+#include <Adafruit_ZeroDMA.h>
 #include <Arduino.h>
 
-Battery::Battery(int pin) : vbatPin_(pin) {}
+// mV per unit of the burst sum, Q16
+static const uint32_t kScale =
+    (kAdcReference * kVbatDivider << 16) / (kAdcMax * kBurstSize);  // NOLINT
+
+// NOLINTBEGIN(*-global-variables)
+static Adafruit_ZeroDMA dma;
+static volatile bool dmaDone = false;
+// NOLINTEND(*-global-variables)
+
+static void OnDmaDone(Adafruit_ZeroDMA* /* dma */) { dmaDone = true; }
+
+static void SyncADC() {
+    while (ADC->STATUS.bit.SYNCBUSY) {
+    }
+}
+
+Battery::Battery(int pin) : vbatPin_(pin), samples_{}, average_(0) {}
+
+void Battery::Begin() {
+    // Let the core configure the pin, the reference and the resolution
+    analogRead(vbatPin_);
+
+    dma.setTrigger(ADC_DMAC_ID_RESRDY);
+    dma.setAction(DMA_TRIGGER_ACTON_BEAT);
+    dma.allocate();
+    dma.addDescriptor((void*)&ADC->RESULT.reg,  // NOLINT
+                      samples_,
+                      kBurstSettle + kBurstSize,
+                      DMA_BEAT_SIZE_HWORD,
+                      false,
+                      true);
+    dma.setCallback(OnDmaDone);
+}
+
+uint32_t Battery::Burst() {
+    ADC->INPUTCTRL.bit.MUXPOS = g_APinDescription[vbatPin_].ulADCChannelNumber;
+    SyncADC();
+    ADC->CTRLB.bit.FREERUN = 1;
+    SyncADC();
+    ADC->CTRLA.bit.ENABLE = 1;
+    SyncADC();
+
+    // A deep sleep leaves SLEEPDEEP set: the WFI below would enter standby,
+    // where the ADC clock stops and the job never ends
+    SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+    dmaDone = false;
+    dma.startJob();
+    ADC->SWTRIG.bit.START = 1;
+    while (!dmaDone) {
+        __WFI();  // woken up by the DMA (or SysTick) interrupt
+    }
+
+    ADC->CTRLA.bit.ENABLE = 0;
+    SyncADC();
+    ADC->CTRLB.bit.FREERUN = 0;
+    SyncADC();
+
+    uint32_t sum = 0;
+    for (int i = kBurstSettle; i < kBurstSettle + kBurstSize; i++) {
+        sum += samples_[i];  // NOLINT
+    }
+    return sum;
+}
 
-// Code from
 uint16_t Battery::Voltage() {
-    return analogRead(vbatPin_);
+    uint32_t mv        = (Burst() * kScale) >> 16;       // NOLINT
+    mv                 = (mv * kCalibrationGain) >> 16;  // NOLINT
+    int32_t calibrated = static_cast<int32_t>(mv) + kCalibrationOffset;
+    auto voltage = static_cast<uint16_t>(constrain(calibrated, 0, 0xFFFF));
+
+    int32_t sample = static_cast<int32_t>(voltage) << 4;  // NOLINT
+    if (average_ == 0) {
+        average_ = sample;
+    } else {
+        average_ += (sample - static_cast<int32_t>(average_)) >> kEmaShift;
+    }
+    return voltage;
 }
+
+uint16_t Battery::Average() const { return (average_ + 8) >> 4; }  // NOLINT
@@ -11,7 +11,9 @@
  * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
  ******************************************************************************
  * @details
- * Battery Driver
+ * Battery Driver. Each reading is a burst of ADC conversions transferred by
+ * DMA while the CPU sleeps, averaged and converted to millivolts in fixed
+ * point. An exponential moving average is kept for thresholding.
  ******************************************************************************
  */
 
@@ -20,11 +22,31 @@
 #include <Arduino.h>
 const int kDefaultVbatPin = A1;  // A1 is indeed 15/AIN2 on Adafruit Feather M0
 
+const uint32_t kAdcReference = 3300;  // mV
+const uint32_t kAdcMax       = 1024;  // 10 bits
+const uint32_t kVbatDivider  = 2;     // VBAT is divided by 2 (2 x 100k)
+
+const int kBurstSettle = 2;   // conversions discarded after the mux change
+const int kBurstSize   = 64;  // conversions averaged
+const int kEmaShift    = 3;   // EMA weight of a new reading: 1/8
+
+// Calibration: mV = raw * kCalibrationGain / 65536 + kCalibrationOffset
+const uint32_t kCalibrationGain  = 65536;
+const int32_t kCalibrationOffset = 0;
+
 class Battery {
    public:
     explicit Battery(int vbatPin = kDefaultVbatPin);
+    void Begin();
+
+    // Fresh reading in mV, also updates the average
     uint16_t Voltage();
+    uint16_t Average() const;  // mV
 
    private:
+    uint32_t Burst();  // sum of kBurstSize conversions
+
     int vbatPin_;
+    uint16_t samples_[kBurstSettle + kBurstSize];
+    uint32_t average_;  // mV, Q4
 };
@@ -0,0 +1,181 @@
+/**
+ ******************************************************************************
+ * @file        : classb.cpp
+ * @brief       : Class B ping-slot manager
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Class B ping-slot manager
+ ******************************************************************************
+ */
+
+#include "classb.hpp"
+
+static const int kMaxShift = 6;  // kBaseRetry << 6 is above kMaxRetry
+
+ClassBManager::ClassBManager()
+    : requested_(kOff),
+      periodicity_(kOff),
+      selectedAt_(0),
+      mode_(kClassA),
+      lowBattery_(false),
+      missed_(0),
+      tracked_(0),
+      failures_(0),
+      retryAt_(0) {}
+
+void ClassBManager::Request(uint8_t periodicity) {
+    requested_ = periodicity > kMaxPeriodicity ? kOff : periodicity;
+    if (requested_ == kOff) {
+        return;
+    }
+    // A new request is worth a scan at once, and a new selection
+    failures_ = 0;
+    if (mode_ == kWaiting) {
+        mode_ = kClassA;
+    }
+    if (mode_ == kTracking) {
+        periodicity_ = kOff;
+    }
+}
+
+uint8_t ClassBManager::Requested() const { return requested_; }
+
+// A fallback in progress still has to tell the network
+void ClassBManager::Reset() {
+    if (mode_ == kScanning || mode_ == kTracking) {
+        mode_        = kClassA;
+        periodicity_ = kOff;
+    }
+}
+
+void ClassBManager::OnBeaconFound() {
+    if (mode_ != kScanning) {
+        return;
+    }
+    mode_        = kTracking;
+    periodicity_ = kOff;  // selected by the next update
+    missed_      = 0;
+    tracked_     = 0;
+}
+
+void ClassBManager::OnBeaconTracked() {
+    missed_ = 0;
+    if (++tracked_ >= kMaxMissed) {
+        failures_ = 0;
+    }
+}
+
+void ClassBManager::OnBeaconMissed(uint32_t now) {
+    if (mode_ != kTracking) {
+        return;
+    }
+    tracked_ = 0;
+    if (++missed_ >= kMaxMissed) {
+        Fallback(now);
+        mode_ = kLost;
+    }
+}
+
+void ClassBManager::OnLostSync(uint32_t now) {
+    if (mode_ != kTracking) {
+        return;
+    }
+    Fallback(now);
+    mode_ = kLost;
+}
+
+// LMIC has already stopped scanning, and the network was never told
+void ClassBManager::OnScanTimeout(uint32_t now) {
+    if (mode_ != kScanning) {
+        return;
+    }
+    Fallback(now);
+    mode_ = kWaiting;
+}
+
+ClassBManager::Action ClassBManager::Update(uint32_t now,
+                                            uint16_t millivolts) {
+    if (millivolts < kLowBattery) {
+        lowBattery_ = true;
+    } else if (millivolts >= kLowBattery + kHysteresis) {
+        lowBattery_ = false;
+    }
+    if (requested_ == kOff || lowBattery_) {
+        // Back to Class A, and scan again as soon as it is allowed
+        bool active  = mode_ != kClassA && mode_ != kWaiting;
+        mode_        = kClassA;
+        periodicity_ = kOff;
+        return active ? kStop : kKeep;
+    }
+
+    switch (mode_) {
+        case kClassA:
+            mode_ = kScanning;
+            return kScan;
+
+        case kWaiting:
+            if (static_cast<int32_t>(now - retryAt_) < 0) {
+                return kKeep;
+            }
+            mode_ = kScanning;
+            return kScan;
+
+        case kLost:
+            mode_        = kWaiting;
+            periodicity_ = kOff;
+            return kStop;
+
+        case kTracking: {
+            bool moved = millivolts + kHysteresis <= selectedAt_ ||
+                         millivolts >= selectedAt_ + kHysteresis;
+            if (periodicity_ != kOff && !moved) {
+                return kKeep;
+            }
+            uint8_t periodicity = Select(millivolts);
+            selectedAt_         = millivolts;
+            if (periodicity == periodicity_) {
+                return kKeep;
+            }
+            periodicity_ = periodicity;
+            return kPing;
+        }
+
+        default:
+            return kKeep;  // scanning
+    }
+}
+
+ClassBManager::Mode ClassBManager::GetMode() const { return mode_; }
+
+uint8_t ClassBManager::Periodicity() const { return periodicity_; }
+
+uint32_t ClassBManager::RetryAt() const { return retryAt_; }
+
+void ClassBManager::Fallback(uint32_t now) {
+    uint32_t retry = kBaseRetry << min(failures_, kMaxShift);
+    if (retry > kMaxRetry) {
+        retry = kMaxRetry;
+    }
+    retryAt_ = now + retry;
+    failures_++;
+    missed_  = 0;
+    tracked_ = 0;
+}
+
+// The requested periodicity on a good battery, one step longer for every
+// eighth of the way down to kLowBattery
+uint8_t ClassBManager::Select(uint16_t millivolts) const {
+    if (millivolts >= kGoodBattery) {
+        return requested_;
+    }
+    int steps = (kGoodBattery - millivolts) * (kMaxPeriodicity + 1) /
+                (kGoodBattery - kLowBattery);
+    return min(requested_ + steps, static_cast<int>(kMaxPeriodicity));
+}
@@ -0,0 +1,86 @@
+/**
+ ******************************************************************************
+ * @file        : classb.hpp
+ * @brief       : Class B ping-slot manager
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Class B ping-slot manager. When Class B is requested (by downlink), the
+ * device scans for a beacon, then tracks the beacons (every 128 s) and
+ * opens a ping slot every 2^periodicity seconds, in which the network can
+ * send a downlink at once instead of waiting for the next uplink.
+ *
+ * The periodicity is the requested one on a good battery, and is stretched
+ * as the battery drains, up to kMaxPeriodicity (one slot every 128 s). A new
+ * selection needs the voltage to move by kHysteresis, as every change costs
+ * an uplink to announce it. Below kLowBattery, the device stays in Class A.
+ *
+ * After kMaxMissed consecutive missed beacons, a lost time sync or a scan
+ * without beacon, the device falls back to Class A and scans again after an
+ * exponential backoff, from kBaseRetry to kMaxRetry. The backoff starts
+ * over once kMaxMissed beacons in a row have been tracked.
+ *
+ * The manager only decides: the caller applies the action to LMIC.
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+class ClassBManager {
+   public:
+    // What the caller has to do with LMIC
+    enum Action { kKeep, kScan, kPing, kStop };
+    enum Mode { kClassA, kScanning, kTracking, kLost, kWaiting };
+
+    static const uint8_t kOff            = 0xFF;          // requested: Class A
+    static const uint8_t kMaxPeriodicity = 7;             // a slot every 128 s
+    static const int kMaxMissed          = 8;             // beacons, 17 min
+    static const uint32_t kBaseRetry     = 30 * 60;       // s
+    static const uint32_t kMaxRetry      = 24 * 60 * 60;  // s
+    static const uint16_t kGoodBattery   = 3800;          // mV
+    static const uint16_t kLowBattery    = 3500;          // mV
+    static const uint16_t kHysteresis    = 50;            // mV
+
+    ClassBManager();
+
+    // Request ping slots every 2^periodicity seconds, or kOff
+    void Request(uint8_t periodicity);
+    uint8_t Requested() const;
+    // The MAC has been reset: tracking and ping slots are gone
+    void Reset();
+
+    void OnBeaconFound();
+    void OnBeaconTracked();
+    void OnBeaconMissed(uint32_t now);
+    void OnLostSync(uint32_t now);
+    void OnScanTimeout(uint32_t now);
+
+    // Decide the next action for the battery voltage
+    Action Update(uint32_t now, uint16_t millivolts);
+
+    Mode GetMode() const;
+    uint8_t Periodicity() const;  // in use, kOff if none
+    uint32_t RetryAt() const;     // next scan, when waiting
+
+   private:
+    void Fallback(uint32_t now);
+    uint8_t Select(uint16_t millivolts) const;
+
+    uint8_t requested_;
+    uint8_t periodicity_;
+    uint16_t selectedAt_;  // mV, at the last selection
+    Mode mode_;
+    bool lowBattery_;
+    int missed_;   // consecutive
+    int tracked_;  // consecutive
+    int failures_;
+    uint32_t retryAt_;
+};
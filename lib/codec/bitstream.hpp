@@ -0,0 +1,138 @@
+/**
+ ******************************************************************************
+ * @file        : bitstream.hpp
+ * @brief       : Bit writer and reader
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Bit writer and reader, MSB first. Writing past the end of the buffer sets
+ * the overflow flag and leaves the buffer untouched, so the caller can roll
+ * back to a previous position with Seek(). Reading past the end, or a
+ * variable length integer wider than 32 bits, sets the overflow flag and
+ * returns 0. Plain C++, shared by the firmware and the host tools.
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+class BitWriter {
+   public:
+    BitWriter(uint8_t* buffer, int size)
+        : buffer_(buffer), size_(size), pos_(0), overflow_(false) {}
+
+    void Put(uint32_t value, int bits) {
+        if (pos_ + bits > size_ * 8) {  // NOLINT
+            overflow_ = true;
+            return;
+        }
+        for (int i = bits - 1; i >= 0; i--) {
+            uint8_t mask = 0x80 >> (pos_ % 8);  // NOLINT
+            if ((value >> i) & 1) {
+                buffer_[pos_ / 8] |= mask;  // NOLINT
+            } else {
+                buffer_[pos_ / 8] &= ~mask;  // NOLINT
+            }
+            pos_++;
+        }
+    }
+
+    // Variable length unsigned integer: groups of `chunk` bits, least
+    // significant first, each one preceded by a "more" bit.
+    void PutVar(uint32_t value, int chunk) {
+        for (;;) {
+            uint32_t low = value & ((1UL << chunk) - 1);
+            value >>= chunk;
+            Put(value != 0 ? 1 : 0, 1);
+            Put(low, chunk);
+            if (value == 0) {
+                return;
+            }
+        }
+    }
+
+    // Signed variant (zigzag encoding)
+    void PutSignedVar(int32_t value, int chunk) {
+        uint32_t zigzag = (static_cast<uint32_t>(value) << 1) ^
+                          static_cast<uint32_t>(value >> 31);  // NOLINT
+        PutVar(zigzag, chunk);
+    }
+
+    int Position() const { return pos_; }
+    void Seek(int pos) {
+        pos_      = pos;
+        overflow_ = false;
+    }
+    bool Overflow() const { return overflow_; }
+    int Bytes() const { return (pos_ + 7) / 8; }  // NOLINT
+
+   private:
+    uint8_t* buffer_;
+    int size_;  // bytes
+    int pos_;   // bits
+    bool overflow_;
+};
+
+class BitReader {
+   public:
+    BitReader(const uint8_t* buffer, int size)
+        : buffer_(buffer), size_(size), pos_(0), overflow_(false) {}
+
+    // Up to 32 bits, one byte at a time
+    uint32_t Get(int bits) {
+        if (pos_ + bits > size_ * 8) {  // NOLINT
+            overflow_ = true;
+            return 0;
+        }
+        uint32_t value = 0;
+        while (bits > 0) {
+            int left  = 8 - pos_ % 8;  // NOLINT
+            int take  = bits < left ? bits : left;
+            int shift = left - take;
+            uint32_t chunk =
+                (buffer_[pos_ / 8] >> shift) & ((1U << take) - 1);  // NOLINT
+            value = value << take | chunk;
+            pos_ += take;
+            bits -= take;
+        }
+        return value;
+    }
+
+    uint32_t GetVar(int chunk) {
+        uint32_t value = 0;
+        for (int shift = 0;; shift += chunk) {
+            uint32_t more = Get(1);
+            uint32_t low  = Get(chunk);
+            if (shift >= 32 || overflow_) {  // NOLINT
+                overflow_ = true;
+                return 0;
+            }
+            value |= low << shift;
+            if (more == 0) {
+                return value;
+            }
+        }
+    }
+
+    int32_t GetSignedVar(int chunk) {
+        uint32_t zigzag = GetVar(chunk);
+        return static_cast<int32_t>(zigzag >> 1) ^
+               -static_cast<int32_t>(zigzag & 1);
+    }
+
+    int Position() const { return pos_; }
+    bool Overflow() const { return overflow_; }
+
+   private:
+    const uint8_t* buffer_;
+    int size_;  // bytes
+    int pos_;   // bits
+    bool overflow_;
+};
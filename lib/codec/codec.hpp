@@ -0,0 +1,517 @@
+/**
+ ******************************************************************************
+ * @file        : codec.hpp
+ * @brief       : Uplink and downlink formats
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Encoders and decoders of the application frames, header-only and in plain
+ * C++, so that the firmware and the backend build the same source.
+ *
+ * Downlink, port 1. Legacy format (exactly kLegacyLength bytes): one nibble
+ * per valve, high nibble first, indexing kPeriods, in minutes (0: nothing to
+ * do, -1: close, -2: open until closed).
+ *
+ * TLV format (any other length):
+ *   byte 0 : version (kVersion)
+ *   then, for each command: opcode (1 byte), length (1 byte), value
+ *
+ *   kOpen              : valve, then 1 to 4 bytes of seconds, LSB first
+ *                        (0: open until closed)
+ *   kClose             : valve
+ *   kSetUplinkInterval : 1 to 4 bytes of seconds, LSB first (0: default)
+ *   kSetSchedule       : schedule entry (see the schedule library)
+ *   kQuery             : what to report (kQueryStatus, kQueryDiagnostics,
+ *                        kQueryValves)
+ *   kSetTime           : local time, seconds since 1 January 1970, 1 to 4
+ *                        bytes, LSB first
+ *   kSequence          : sequence number of the frame, 1 or 2 bytes, LSB
+ *                        first, to drop replays (see the commands library)
+ *   kSetClassB         : Class B ping-slot periodicity, 0 to 7 (a slot
+ *                        every 2^n seconds), or 0xFF for Class A (see the
+ *                        classb library)
+ *
+ * Every command has at least one byte of value, so a TLV frame is never
+ * kLegacyLength bytes long. Unknown opcodes are skipped. A frame with a
+ * bad version or a truncated command is rejected as a whole.
+ *
+ * Telemetry uplink, port 3:
+ *   byte 0    : version (kVersion)
+ *   bytes 1-4 : RTC time of the frame, LSB first
+ *   byte 5    : number of records
+ *   byte 6    : number of valves
+ *   byte 7    : number of records lost since the last frame (saturated)
+ * followed by the records, bit-packed MSB first, oldest first:
+ *   kind      : 2 bits (0: sample, 1: opened, 2: closed, 3: timeout)
+ *   dt        : var(6), age of the first record, then delta to the previous
+ *   sample    : voltage delta in mV, signed var(3), from 0 for the first one
+ *               valves changed flag (1 bit) + valve bitmask if set
+ *   event     : valve index (5 bits)
+ * var(n) is a sequence of groups of n bits, least significant first, each
+ * preceded by a "more" bit. Signed values are zigzag encoded. The valve
+ * statistics block may follow the records, from the next byte boundary.
+ *
+ * Valve statistics since the reset, port 5 (on request):
+ *   byte 0    : version (kVersion)
+ *   bytes 1-4 : RTC time of the frame, LSB first
+ * followed by the block, LEB128 varints:
+ *   mask of the valves in the block
+ *   for each of them, by index: open time in seconds (up to the time of the
+ *   frame), coil pulses, failed closes, forced closes, and the age of the
+ *   last change in seconds, plus one (0: no change since the reset)
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#include "bitstream.hpp"
+
+struct Command {
+    enum Opcode : uint8_t {
+        kOpen              = 0x01,
+        kClose             = 0x02,
+        kSetUplinkInterval = 0x03,
+        kSetSchedule       = 0x04,
+        kQuery             = 0x05,
+        kSetTime           = 0x06,
+        kSequence          = 0x07,
+        kSetClassB         = 0x08,
+    };
+
+    uint8_t opcode;
+    uint8_t valve;
+    uint32_t value;       // seconds, or what to query
+    const uint8_t* data;  // raw value, points into the frame
+    uint8_t len;
+};
+
+const uint8_t kQueryStatus      = 0;
+const uint8_t kQueryDiagnostics = 1;
+const uint8_t kQueryValves      = 2;
+
+struct DownlinkFormat {
+    static const uint8_t kVersion     = 1;
+    static const int kLegacyLength    = 3;
+    static const int kLegacyNOfValves = 2 * kLegacyLength;
+    static constexpr int kPeriods[16] = {
+        0, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, -2, -1};
+
+    static uint32_t ReadLE(const uint8_t* data, int len) {
+        uint32_t value = 0;
+        for (int i = len - 1; i >= 0; i--) {
+            value = (value << 8) | data[i];  // NOLINT
+        }
+        return value;
+    }
+
+    static void WriteLE(uint8_t* data, uint32_t value, int len) {
+        for (int i = 0; i < len; i++) {
+            data[i] = value & 0xFF;  // NOLINT
+            value >>= 8;             // NOLINT
+        }
+    }
+};
+
+// TLV downlink encoder. Multi-byte values are written on 4 bytes.
+class DownlinkWriter : public DownlinkFormat {
+   public:
+    DownlinkWriter(uint8_t* buffer, int size)
+        : buffer_(buffer), size_(size), len_(0) {
+        if (size_ > 0) {
+            buffer_[len_++] = kVersion;
+        }
+    }
+
+    bool Open(uint8_t valve, uint32_t seconds) {
+        uint8_t value[5] = {valve};  // NOLINT
+        WriteLE(value + 1, seconds, 4);
+        return Add(Command::kOpen, value, sizeof(value));
+    }
+    bool Close(uint8_t valve) { return Add(Command::kClose, &valve, 1); }
+    bool SetUplinkInterval(uint32_t seconds) {
+        return AddLE(Command::kSetUplinkInterval, seconds);
+    }
+    bool SetSchedule(uint8_t slot,
+                     uint8_t valve,
+                     uint8_t days,
+                     uint16_t start,
+                     uint32_t seconds) {
+        uint8_t value[9] = {slot, valve, days};  // NOLINT
+        WriteLE(value + 3, start, 2);
+        WriteLE(value + 5, seconds, 4);  // NOLINT
+        return Add(Command::kSetSchedule, value, sizeof(value));
+    }
+    bool Query(uint8_t what) { return Add(Command::kQuery, &what, 1); }
+    bool SetTime(uint32_t time) { return AddLE(Command::kSetTime, time); }
+    bool Sequence(uint16_t sequence) {
+        uint8_t value[2];
+        WriteLE(value, sequence, sizeof(value));
+        return Add(Command::kSequence, value, sizeof(value));
+    }
+    bool SetClassB(uint8_t periodicity) {
+        return Add(Command::kSetClassB, &periodicity, 1);
+    }
+
+    // Append a command, return false if it does not fit
+    bool Add(uint8_t opcode, const uint8_t* value, int len) {
+        if (len < 1 || len > UINT8_MAX || len_ + 2 + len > size_) {
+            return false;
+        }
+        buffer_[len_++] = opcode;
+        buffer_[len_++] = len;
+        memcpy(buffer_ + len_, value, len);
+        len_ += len;
+        return true;
+    }
+
+    int Length() const { return len_; }
+
+   private:
+    bool AddLE(uint8_t opcode, uint32_t value) {
+        uint8_t bytes[4];
+        WriteLE(bytes, value, sizeof(bytes));
+        return Add(opcode, bytes, sizeof(bytes));
+    }
+
+    uint8_t* buffer_;
+    int size_;
+    int len_;
+};
+
+struct TelemetryRecord {
+    uint32_t time;
+    uint32_t valves;
+    uint16_t millivolts;
+    uint8_t kind;
+    uint8_t valve;
+};
+
+struct TelemetryFormat {
+    enum Kind { kSample = 0, kOpened = 1, kClosed = 2, kTimeout = 3 };
+
+    static const uint8_t kVersion    = 1;
+    static const int kHeaderSize     = 8;
+    static const int kMaxRecords     = 255;
+    static const int kMaxValves      = 32;
+    static const int kKindBits       = 2;
+    static const int kTimeChunk      = 6;
+    static const int kVoltageChunk   = 3;
+    static const int kValveIndexBits = 5;
+};
+
+// Telemetry encoder: records are added oldest first, as long as they fit
+class TelemetryWriter : public TelemetryFormat {
+   public:
+    TelemetryWriter(uint8_t* buffer, int size, uint32_t now, int nOfValves)
+        : buffer_(buffer),
+          writer_(buffer + kHeaderSize,
+                  size > kHeaderSize ? size - kHeaderSize : 0),
+          now_(now),
+          nOfValves_(nOfValves),
+          count_(0),
+          previousTime_(now),
+          previousVoltage_(0),
+          previousValves_(0) {}
+
+    // Append a record, return false (the frame is unchanged) if it does
+    // not fit
+    bool Add(const TelemetryRecord& record) {
+        if (count_ == kMaxRecords) {
+            return false;
+        }
+        int mark = writer_.Position();
+        writer_.Put(record.kind, kKindBits);
+        writer_.PutVar(count_ == 0 ? now_ - record.time
+                                   : record.time - previousTime_,
+                       kTimeChunk);
+        if (record.kind == kSample) {
+            writer_.PutSignedVar(record.millivolts - previousVoltage_,
+                                 kVoltageChunk);
+            if (record.valves != previousValves_) {
+                writer_.Put(1, 1);
+                writer_.Put(record.valves, nOfValves_);
+            } else {
+                writer_.Put(0, 1);
+            }
+        } else {
+            writer_.Put(record.valve, kValveIndexBits);
+        }
+
+        if (writer_.Overflow()) {
+            writer_.Seek(mark);
+            return false;
+        }
+        previousTime_ = record.time;
+        if (record.kind == kSample) {
+            previousVoltage_ = record.millivolts;
+            previousValves_  = record.valves;
+        }
+        count_++;
+        return true;
+    }
+
+    int Count() const { return count_; }
+
+    // Write the header, return the length of the frame (0 if it is empty)
+    int Finish(int lost) {
+        if (count_ == 0) {
+            return 0;
+        }
+        buffer_[0] = kVersion;
+        DownlinkFormat::WriteLE(buffer_ + 1, now_, 4);
+        buffer_[5] = count_;                   // NOLINT
+        buffer_[6] = nOfValves_;               // NOLINT
+        buffer_[7] = lost < 255 ? lost : 255;  // NOLINT
+        return kHeaderSize + writer_.Bytes();
+    }
+
+   private:
+    uint8_t* buffer_;
+    BitWriter writer_;
+    uint32_t now_;
+    int nOfValves_;
+    int count_;
+    uint32_t previousTime_;
+    int32_t previousVoltage_;
+    uint32_t previousValves_;
+};
+
+// Telemetry decoder, one record at a time. Events carry no valve bitmask.
+class TelemetryReader : public TelemetryFormat {
+   public:
+    TelemetryReader(const uint8_t* data, int len)
+        : reader_(data + kHeaderSize,
+                  len > kHeaderSize ? len - kHeaderSize : 0),
+          time_(0),
+          count_(0),
+          nOfValves_(0),
+          lost_(0),
+          n_(0),
+          previousTime_(0),
+          voltage_(0),
+          valves_(0),
+          valid_(false) {
+        if (len < kHeaderSize || data[0] != kVersion ||
+            data[6] > kMaxValves) {  // NOLINT
+            return;
+        }
+        time_      = DownlinkFormat::ReadLE(data + 1, 4);
+        count_     = data[5];  // NOLINT
+        nOfValves_ = data[6];  // NOLINT
+        lost_      = data[7];  // NOLINT
+        valid_     = true;
+    }
+
+    // False if the header is invalid, or after a truncated record
+    bool IsValid() const { return valid_; }
+    uint32_t Time() const { return time_; }
+    int Count() const { return count_; }
+    int NOfValves() const { return nOfValves_; }
+    int Lost() const { return lost_; }
+    // Length of the frame up to the last record decoded
+    int Length() const { return kHeaderSize + (reader_.Position() + 7) / 8; }
+
+    // Decode the next record, return false at the end of the frame
+    bool Next(TelemetryRecord* record) {
+        if (!valid_ || n_ == count_) {
+            return false;
+        }
+        uint8_t kind  = reader_.Get(kKindBits);
+        uint32_t dt   = reader_.GetVar(kTimeChunk);
+        previousTime_ = n_ == 0 ? time_ - dt : previousTime_ + dt;
+        record->time  = previousTime_;
+        record->kind  = kind;
+        if (kind == kSample) {
+            voltage_ += reader_.GetSignedVar(kVoltageChunk);
+            if (reader_.Get(1) != 0) {
+                valves_ = reader_.Get(nOfValves_);
+            }
+            record->millivolts = voltage_;
+            record->valves     = valves_;
+            record->valve      = 0;
+        } else {
+            record->millivolts = 0;
+            record->valves     = 0;
+            record->valve      = reader_.Get(kValveIndexBits);
+        }
+        if (reader_.Overflow()) {
+            valid_ = false;
+            return false;
+        }
+        n_++;
+        return true;
+    }
+
+   private:
+    BitReader reader_;
+    uint32_t time_;
+    int count_;
+    int nOfValves_;
+    int lost_;
+    int n_;
+    uint32_t previousTime_;
+    int32_t voltage_;
+    uint32_t valves_;
+    bool valid_;
+};
+
+// Unsigned LEB128: groups of 7 bits, least significant first, the high bit
+// set on all but the last one. Also used by the profile and the memory report
+struct Varint {
+    static const int kMaxSize32 = 5;   // bytes for 32 bits
+    static const int kMaxSize64 = 10;  // bytes for 64 bits
+
+    // Return the number of bytes written, 0 if the value does not fit
+    template <typename T>
+    static int Put(uint8_t* buffer, int size, T value) {
+        static_assert(static_cast<T>(-1) > 0, "unsigned values only");
+        int n = 0;
+        do {
+            if (n == size) {
+                return 0;
+            }
+            uint8_t byte = value & 0x7F;  // NOLINT
+            value >>= 7;                  // NOLINT
+            buffer[n++] = value != 0 ? byte | 0x80 : byte;  // NOLINT
+        } while (value != 0);
+        return n;
+    }
+
+    // Return the number of bytes read, 0 if truncated or too long
+    static int Get(const uint8_t* data, int len, uint32_t* value) {
+        *value = 0;
+        for (int n = 0; n < len && n < kMaxSize32; n++) {
+            *value |= static_cast<uint32_t>(data[n] & 0x7F) << (7 * n);
+            if ((data[n] & 0x80) == 0) {  // NOLINT
+                return n + 1;
+            }
+        }
+        return 0;
+    }
+};
+
+struct ValveStats {
+    uint32_t openSeconds;   // including the current opening
+    uint32_t lastChange;    // RTC time, 0 if none
+    uint16_t actuations;    // coil pulses
+    uint16_t failedCloses;  // pulse not queued, or latch not sensed
+    uint16_t forcedCloses;  // close pulses on a closed valve, at startup
+};
+
+struct ValveStatsFormat {
+    static const uint8_t kVersion = 1;
+    static const int kHeaderSize  = 5;
+    static const int kMaxValves   = 32;
+};
+
+// Valve statistics block, alone or appended to a telemetry frame
+class ValveStatsWriter : public ValveStatsFormat {
+   public:
+    // Encode the valves in `mask`, return the length of the block, 0 if it
+    // does not fit
+    static int Encode(uint8_t* buffer,
+                      int size,
+                      uint32_t now,
+                      uint32_t mask,
+                      const ValveStats* stats) {
+        int len = Varint::Put(buffer, size, mask);
+        for (int i = 0; i < kMaxValves && len > 0; i++) {
+            if ((mask & (1UL << i)) == 0) {
+                continue;
+            }
+            const ValveStats& s = stats[i];
+            uint32_t age = s.lastChange == 0 ? 0 : now - s.lastChange + 1;
+            uint32_t fields[] = {s.openSeconds,
+                                 s.actuations,
+                                 s.failedCloses,
+                                 s.forcedCloses,
+                                 age};
+            for (uint32_t field : fields) {
+                int n = Varint::Put(buffer + len, size - len, field);
+                if (n == 0) {
+                    return 0;
+                }
+                len += n;
+            }
+        }
+        return len;
+    }
+
+    // Frame on its own port: header and block
+    static int EncodeFrame(uint8_t* buffer,
+                           int size,
+                           uint32_t now,
+                           uint32_t mask,
+                           const ValveStats* stats) {
+        if (size <= kHeaderSize) {
+            return 0;
+        }
+        buffer[0] = kVersion;
+        DownlinkFormat::WriteLE(buffer + 1, now, 4);
+        int len = Encode(buffer + kHeaderSize, size - kHeaderSize, now, mask,
+                         stats);
+        return len == 0 ? 0 : kHeaderSize + len;
+    }
+};
+
+// Valve statistics decoder, one valve at a time
+class ValveStatsReader : public ValveStatsFormat {
+   public:
+    ValveStatsReader(const uint8_t* data, int len, uint32_t now)
+        : data_(data), len_(len), pos_(0), now_(now), mask_(0), valid_(true) {
+        int n = Varint::Get(data_, len_, &mask_);
+        valid_ = n > 0;
+        pos_   = n;
+    }
+
+    // False if the block is truncated
+    bool IsValid() const { return valid_; }
+    uint32_t Mask() const { return mask_; }
+
+    // Decode the next valve, return false at the end of the block
+    bool Next(int* valve, ValveStats* stats) {
+        if (!valid_ || mask_ == 0) {
+            return false;
+        }
+        int i = 0;
+        while ((mask_ & (1UL << i)) == 0) {
+            i++;
+        }
+        uint32_t fields[5];  // NOLINT
+        for (uint32_t& field : fields) {
+            int n = Varint::Get(data_ + pos_, len_ - pos_, &field);
+            if (n == 0) {
+                valid_ = false;
+                return false;
+            }
+            pos_ += n;
+        }
+        mask_ &= ~(1UL << i);
+        *valve              = i;
+        stats->openSeconds  = fields[0];
+        stats->actuations   = fields[1];
+        stats->failedCloses = fields[2];
+        stats->forcedCloses = fields[3];
+        stats->lastChange   = fields[4] == 0 ? 0 : now_ - (fields[4] - 1);
+        return true;
+    }
+
+    int Length() const { return pos_; }
+
+   private:
+    const uint8_t* data_;
+    int len_;
+    int pos_;
+    uint32_t now_;
+    uint32_t mask_;  // valves left
+    bool valid_;
+};
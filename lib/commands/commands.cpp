@@ -0,0 +1,121 @@
+/**
+ ******************************************************************************
+ * @file        : commands.cpp
+ * @brief       : Downlink command queue
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Downlink command queue
+ ******************************************************************************
+ */
+
+#include "commands.hpp"
+
+CommandQueue::CommandQueue()
+    : items_{}, count_(0), sequence_(0), hasSequence_(false) {}
+
+bool CommandQueue::Accept(uint16_t sequence) {
+    if (hasSequence_ && static_cast<int16_t>(sequence - sequence_) <= 0) {
+        return false;
+    }
+    Restore(sequence);
+    return true;
+}
+
+bool CommandQueue::HasSequence() const { return hasSequence_; }
+
+uint16_t CommandQueue::Sequence() const { return sequence_; }
+
+void CommandQueue::Restore(uint16_t sequence) {
+    sequence_    = sequence;
+    hasSequence_ = true;
+}
+
+bool CommandQueue::Push(const Command& command) {
+    Item item         = {};
+    item.command      = command;
+    item.command.data = nullptr;  // set by Pop()
+    if (command.data == nullptr || command.len > kMaxValue) {
+        item.command.len = 0;
+    } else {
+        memcpy(item.value, command.data, command.len);
+    }
+
+    uint16_t target = Target(item);
+    for (int i = 0; i < count_; i++) {
+        if (Target(items_[i]) == target) {
+            Remove(i);
+            break;
+        }
+    }
+    if (count_ == kMaxCommands) {
+        return false;
+    }
+    items_[count_++] = item;
+    return true;
+}
+
+bool CommandQueue::Pop(Item* item) {
+    if (count_ == 0) {
+        return false;
+    }
+    int next = 0;
+    for (int i = 1; i < count_; i++) {
+        if (Priority(items_[i].command.opcode) <
+            Priority(items_[next].command.opcode)) {
+            next = i;
+        }
+    }
+    *item              = items_[next];
+    item->command.data = item->value;
+    Remove(next);
+    return true;
+}
+
+int CommandQueue::Count() const { return count_; }
+
+int CommandQueue::Priority(uint8_t opcode) {
+    switch (opcode) {
+        case Command::kClose:
+            return 0;
+        case Command::kOpen:
+            return 1;
+        case Command::kSetTime:  // the schedules run on local time
+            return 2;
+        case Command::kSetSchedule:
+            return 3;
+        case Command::kSetUplinkInterval:
+            return 4;
+        default:
+            return 5;  // NOLINT
+    }
+}
+
+// Opcode (open and close share the valve), then valve, slot or query
+uint16_t CommandQueue::Target(const Item& item) {
+    const Command& command = item.command;
+    switch (command.opcode) {
+        case Command::kOpen:
+        case Command::kClose:
+            return Command::kOpen << 8 | command.valve;  // NOLINT
+        case Command::kSetSchedule:
+            return Command::kSetSchedule << 8 | item.value[0];  // NOLINT
+        case Command::kQuery:
+            return Command::kQuery << 8 | (command.value & 0xFF);  // NOLINT
+        default:
+            return command.opcode << 8;  // NOLINT
+    }
+}
+
+void CommandQueue::Remove(int index) {
+    count_--;
+    for (int i = index; i < count_; i++) {
+        items_[i] = items_[i + 1];
+    }
+}
@@ -0,0 +1,73 @@
+/**
+ ******************************************************************************
+ * @file        : commands.hpp
+ * @brief       : Downlink command queue
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Bounded queue of the downlink commands. The LMIC callback only decodes
+ * the frame and queues its commands; the main loop runs them.
+ *
+ * A command replaces the queued one with the same target: the same valve
+ * (open or close), the same schedule slot, or the same setting. The queue
+ * yields the commands by priority, closes first, then opens, the clock and
+ * the schedules, the settings, and the queries last, so that the status
+ * uplink reports their effect. Commands of the same priority keep their
+ * order.
+ *
+ * Downlinks with a sequence number (kSequence) are only accepted if it is
+ * newer than the last one accepted (16-bit serial arithmetic), so that a
+ * replayed downlink is dropped before any of its commands is queued.
+ * Number 0 is no exception: a backend that lost its count moves on by up to
+ * 32767 from any number it has used since.
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+#include "codec.hpp"
+
+class CommandQueue {
+   public:
+    static const int kMaxCommands = 16;
+    static const int kMaxValue    = 9;  // longest value, a schedule entry
+
+    struct Item {
+        Command command;  // data points to value, once dequeued
+        uint8_t value[kMaxValue];
+    };
+
+    CommandQueue();
+
+    // Return false if the sequence number is a replay
+    bool Accept(uint16_t sequence);
+    bool HasSequence() const;
+    uint16_t Sequence() const;  // last accepted
+    // Restore the last sequence number accepted before a reset
+    void Restore(uint16_t sequence);
+
+    // Queue a command, return false if the queue is full. A value longer
+    // than kMaxValue is dropped (len 0).
+    bool Push(const Command& command);
+    // Dequeue the command with the highest priority, false if none
+    bool Pop(Item* item);
+    int Count() const;
+
+   private:
+    static int Priority(uint8_t opcode);
+    static uint16_t Target(const Item& item);
+    void Remove(int index);
+
+    Item items_[kMaxCommands];  // in arrival order
+    int count_;
+    uint16_t sequence_;
+    bool hasSequence_;
+};
@@ -0,0 +1,76 @@
+/**
+ ******************************************************************************
+ * @file        : gpio.hpp
+ * @brief       : Direct port I/O
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Direct port I/O. Arduino pin numbers of the Adafruit Feather M0 are mapped
+ * to a port and a bit at compile time, so that setting or clearing a pin is
+ * a single write to the OUTSET or OUTCLR register (instead of the table
+ * lookups of digitalWrite), and that all the pins of a port can be changed
+ * at once from a mask.
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+const int kPorts = 2;  // PORTA, PORTB
+
+struct PortPin {
+    uint8_t port;
+    uint8_t bit;
+
+    constexpr uint32_t Mask() const { return 1UL << bit; }
+    constexpr bool IsValid() const { return port < kPorts; }
+};
+
+constexpr PortPin kNoPin = {0xFF, 0};
+
+// Adafruit Feather M0 (Arduino Zero variant), pins 0 to 24
+constexpr PortPin kFeatherPins[] = {
+    {0, 11}, {0, 10}, {0, 14}, {0, 9},  {0, 8},  {0, 15}, {0, 20},
+    {0, 21}, {0, 6},  {0, 7},  {0, 18}, {0, 16}, {0, 19}, {0, 17},
+    {0, 2},  {1, 8},  {1, 9},  {0, 4},  {0, 5},  {1, 2},  {0, 22},
+    {0, 23}, {0, 12}, {1, 10}, {1, 11}};
+
+constexpr int kFeatherPinCount = sizeof(kFeatherPins) / sizeof(PortPin);
+
+constexpr PortPin FeatherPin(int pin) {
+    return pin >= 0 && pin < kFeatherPinCount ? kFeatherPins[pin] : kNoPin;
+}
+
+inline void SetPin(PortPin pin) {
+    PORT->Group[pin.port].OUTSET.reg = pin.Mask();
+}
+
+inline void ClearPin(PortPin pin) {
+    PORT->Group[pin.port].OUTCLR.reg = pin.Mask();
+}
+
+inline bool ReadPin(PortPin pin) {
+    return (PORT->Group[pin.port].IN.reg & pin.Mask()) != 0;
+}
+
+inline void ConfigureInput(PortPin pin) {
+    PORT->Group[pin.port].DIRCLR.reg          = pin.Mask();
+    PORT->Group[pin.port].PINCFG[pin.bit].reg = PORT_PINCFG_INEN;
+}
+
+// Drive low, then make outputs, all the pins of `mask` at once
+inline void ConfigureOutputs(int port, uint32_t mask) {
+    PORT->Group[port].OUTCLR.reg = mask;
+    PORT->Group[port].DIRSET.reg = mask;
+}
+
+inline void ClearPins(int port, uint32_t mask) {
+    PORT->Group[port].OUTCLR.reg = mask;
+}
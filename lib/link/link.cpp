@@ -0,0 +1,122 @@
+/**
+ ******************************************************************************
+ * @file        : link.cpp
+ * @brief       : Data rate and TX power manager
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Data rate and TX power manager
+ ******************************************************************************
+ */
+
+#include "link.hpp"
+
+static const int kAverageShift = 2;  // weight of a new sample: 1/4
+static const int kFixed        = 16;
+
+// Minimum SNR to demodulate, in dB x 4, for DR0 (SF12) to DR5 (SF7)
+static const int kSnrFloor[] = {-80, -70, -60, -50, -40, -30};
+
+LinkManager::LinkManager(int dataRate, int txPower)
+    : dataRate_(dataRate),
+      txPower_(txPower),
+      margin_(0),
+      rssi_(0),
+      samples_(0),
+      changes_(0),
+      last_(kKeep) {}
+
+void LinkManager::Reset() { samples_ = 0; }
+
+void LinkManager::OnDownlink(int dataRate, int snr, int rssi) {
+    if (dataRate < kSlowest || dataRate > kFastest) {
+        return;
+    }
+    // The downlink does not see our TX power: the uplink margin is lower
+    // by the power reduction.
+    int margin = (snr - kSnrFloor[dataRate]) * kFixed / 4 -
+                 (kMaxTxPower - txPower_) * kFixed;
+    if (samples_ == 0) {
+        margin_ = margin;
+    } else {
+        margin_ += (margin - margin_) >> kAverageShift;  // NOLINT
+    }
+    rssi_ = rssi;
+    samples_++;
+}
+
+void LinkManager::OnSettings(int dataRate, int txPower) {
+    if (dataRate == dataRate_ && txPower == txPower_) {
+        return;
+    }
+    dataRate_ = dataRate;
+    txPower_  = txPower;
+    last_     = kNetwork;
+    changes_++;
+    Reset();
+}
+
+void LinkManager::OnFailure() {
+    Reset();
+    if (txPower_ < kMaxTxPower) {
+        txPower_ = kMaxTxPower;
+        last_    = kMorePower;
+    } else if (dataRate_ > kSlowest) {
+        dataRate_--;
+        last_ = kSlower;
+    } else {
+        return;
+    }
+    changes_++;
+}
+
+LinkManager::Decision LinkManager::Update() {
+    if (samples_ < kMinSamples) {
+        return kKeep;
+    }
+    int margin        = margin_ / kFixed;
+    Decision decision = kKeep;
+    if (margin > kHighMargin) {
+        if (dataRate_ < kFastest) {
+            dataRate_++;
+            decision = kFaster;
+        } else if (txPower_ - kPowerStep >= kMinTxPower) {
+            txPower_ -= kPowerStep;
+            decision = kLessPower;
+        }
+    } else if (margin < kLowMargin) {
+        if (txPower_ < kMaxTxPower) {
+            txPower_ = txPower_ + kPowerStep < kMaxTxPower
+                           ? txPower_ + kPowerStep
+                           : kMaxTxPower;
+            decision = kMorePower;
+        } else if (dataRate_ > kSlowest) {
+            dataRate_--;
+            decision = kSlower;
+        }
+    }
+    if (decision != kKeep) {
+        last_ = decision;
+        changes_++;
+        Reset();
+    }
+    return decision;
+}
+
+int LinkManager::DataRate() const { return dataRate_; }
+
+int LinkManager::TxPower() const { return txPower_; }
+
+int LinkManager::Margin() const { return margin_ / kFixed; }
+
+int LinkManager::Rssi() const { return rssi_; }
+
+int LinkManager::Changes() const { return changes_; }
+
+LinkManager::Decision LinkManager::LastDecision() const { return last_; }
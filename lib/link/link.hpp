@@ -0,0 +1,77 @@
+/**
+ ******************************************************************************
+ * @file        : link.hpp
+ * @brief       : Data rate and TX power manager
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Data rate and TX power manager (EU868, 125 kHz data rates). The link
+ * margin is the SNR of the received downlinks above the demodulation floor
+ * of their spreading factor, less the TX power reduction (the downlinks
+ * are sent at full power), averaged over the last few downlinks. When the
+ * margin is high, the manager first speeds up the data rate, then lowers the
+ * TX power; when it is low, it first raises the power, then slows the data
+ * rate. Between the two thresholds, nothing changes (hysteresis), and a
+ * decision needs kMinSamples downlinks since the previous one.
+ *
+ * Only one side drives the settings: the device turns the network ADR off
+ * (ADR bit clear in its uplinks), so that the network server does not send
+ * LinkADRReq commands that undo the local decisions at every downlink. The
+ * settings that LMIC still changes on its own (the link check back-off to
+ * slower data rates when the network stays silent, or a LinkADRReq sent
+ * anyway) are adopted as the new starting point.
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+class LinkManager {
+   public:
+    enum Decision { kKeep, kFaster, kSlower, kLessPower, kMorePower, kNetwork };
+
+    static const int kSlowest      = 0;   // DR0, SF12
+    static const int kFastest      = 5;   // DR5, SF7
+    static const int kMinTxPower   = 2;   // dBm
+    static const int kMaxTxPower   = 14;  // dBm
+    static const int kPowerStep    = 3;   // dB
+    static const int kHighMargin   = 10;  // dB
+    static const int kLowMargin    = 3;   // dB
+    static const int kMinSamples   = 3;
+
+    explicit LinkManager(int dataRate = kFastest, int txPower = kMaxTxPower);
+
+    // Report a downlink received at `dataRate`, SNR in 0.25 dB steps
+    void OnDownlink(int dataRate, int snr, int rssi);
+    // Report the settings in use, which the network may have changed
+    void OnSettings(int dataRate, int txPower);
+    // An uplink did not complete: slow down at once
+    void OnFailure();
+    // Decide the next settings from the margin
+    Decision Update();
+
+    int DataRate() const;
+    int TxPower() const;
+    int Margin() const;  // dB, averaged
+    int Rssi() const;    // dBm, last downlink
+    int Changes() const;
+    Decision LastDecision() const;
+
+   private:
+    void Reset();
+
+    int dataRate_;
+    int txPower_;
+    int margin_;  // dB x 16, exponential average
+    int rssi_;
+    int samples_;  // since the last change
+    int changes_;
+    Decision last_;
+};
@@ -0,0 +1,85 @@
+/**
+ ******************************************************************************
+ * @file        : memory.cpp
+ * @brief       : RAM usage monitor
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * RAM usage monitor
+ ******************************************************************************
+ */
+
+#include "memory.hpp"
+
+#include "codec.hpp"
+
+#if defined(__arm__)
+// Newlib and the linker script of the core
+extern "C" char* sbrk(int incr);
+extern "C" char __end__;      // NOLINT, end of .bss, start of the heap
+extern "C" char __StackTop;  // NOLINT, top of the RAM
+
+static uintptr_t HeapEnd() { return reinterpret_cast<uintptr_t>(sbrk(0)); }
+static uintptr_t HeapStart() { return reinterpret_cast<uintptr_t>(&__end__); }
+static uintptr_t StackTop() { return reinterpret_cast<uintptr_t>(&__StackTop); }
+static uintptr_t StackPointer() { return __get_MSP(); }
+#else
+static uintptr_t HeapEnd() { return 0; }
+static uintptr_t HeapStart() { return 0; }
+static uintptr_t StackTop() { return 0; }
+static uintptr_t StackPointer() { return 0; }
+#endif
+
+MemoryMonitor Memory;  // NOLINT
+
+MemoryMonitor::MemoryMonitor() : painted_(0) {}
+
+void MemoryMonitor::Begin() {
+    uintptr_t sp = StackPointer();
+    if (sp < kGuard) {
+        return;
+    }
+    auto* word = reinterpret_cast<uint32_t*>((HeapEnd() + 3) & ~3U);
+    auto* top  = reinterpret_cast<uint32_t*>((sp - kGuard) & ~3U);
+    painted_   = reinterpret_cast<uintptr_t>(top);
+    while (word < top) {
+        *word++ = kPaint;
+    }
+}
+
+uintptr_t MemoryMonitor::Deepest() const {
+    const auto* word = reinterpret_cast<const uint32_t*>((HeapEnd() + 3) & ~3U);
+    const auto* top  = reinterpret_cast<const uint32_t*>(painted_);
+    while (word < top && *word == kPaint) {
+        word++;
+    }
+    return reinterpret_cast<uintptr_t>(word);
+}
+
+uint32_t MemoryMonitor::StackHighWater() const {
+    return painted_ == 0 ? 0 : StackTop() - Deepest();
+}
+
+uint32_t MemoryMonitor::HeapSize() const { return HeapEnd() - HeapStart(); }
+
+uint32_t MemoryMonitor::FreeLowWater() const {
+    return painted_ == 0 ? 0 : Deepest() - HeapEnd();
+}
+
+int MemoryMonitor::Encode(uint8_t* buffer, int size) const {
+    uint8_t fields[kMaxEncodedSize];
+    int n = Varint::Put(fields, sizeof(fields), StackHighWater());
+    n += Varint::Put(fields + n, sizeof(fields) - n, HeapSize());
+    n += Varint::Put(fields + n, sizeof(fields) - n, FreeLowWater());
+    if (n > size) {
+        return 0;
+    }
+    memcpy(buffer, fields, n);
+    return n;
+}
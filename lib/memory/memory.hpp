@@ -0,0 +1,56 @@
+/**
+ ******************************************************************************
+ * @file        : memory.hpp
+ * @brief       : RAM usage monitor
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * RAM usage at run time. The static data (.data and .bss) is fixed at link
+ * time (see tools/memory_report.py). Above it, the heap grows up from the
+ * end of .bss and the stack grows down from the top of the RAM.
+ *
+ * Begin() paints the free RAM between the two with kPaint. The deepest
+ * stack use since then is the lowest word that is not painted any more, so
+ * the high-water mark costs nothing until it is queried (a scan of the free
+ * RAM, about a millisecond).
+ *
+ * Memory block of the diagnostic frame (Encode), as LEB128 varints: stack
+ * high-water mark, heap size and free RAM low-water mark, in bytes.
+ *
+ * On the host (simulator), nothing is measured and everything reads 0.
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+class MemoryMonitor {
+   public:
+    static const uint32_t kPaint     = 0xC0DEC0DE;
+    static const uint32_t kGuard     = 64;  // bytes left below the caller
+    static const int kMaxEncodedSize = 3 * 5;
+
+    MemoryMonitor();
+    // Paint the free RAM, as early as possible in setup()
+    void Begin();
+
+    uint32_t StackHighWater() const;  // bytes, deepest use
+    uint32_t HeapSize() const;        // bytes
+    uint32_t FreeLowWater() const;    // bytes never used by either
+
+    int Encode(uint8_t* buffer, int size) const;
+
+   private:
+    uintptr_t Deepest() const;  // lowest address reached by the stack
+
+    uintptr_t painted_;  // top of the painted area
+};
+
+extern MemoryMonitor Memory;  // NOLINT
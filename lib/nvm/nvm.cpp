@@ -0,0 +1,138 @@
+/**
+ ******************************************************************************
+ * @file        : nvm.cpp
+ * @brief       : Non-volatile storage in flash
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Non-volatile storage in flash
+ ******************************************************************************
+ */
+
+#include "nvm.hpp"
+
+static const uint32_t kMagic = 0x5641564C;  // "LVAV"
+
+// Reserved flash area. The array is const, so the linker places it in flash,
+// and row aligned, so that erasing a row does not touch the program.
+__attribute__((__aligned__(Nvm::kRowSize))) static const uint8_t
+    kArea[Nvm::kSlots * Nvm::kSlotSize] = {};  // NOLINT
+
+Nvm::Nvm() : slot_(-1), sequence_(0) {}
+
+// The area is read through a volatile pointer, otherwise the compiler may
+// assume that it still holds its initial (zero) content.
+const uint8_t* Nvm::Slot(int slot) {
+    const uint8_t* volatile area = kArea;
+    return area + slot * kSlotSize;
+}
+
+uint16_t Nvm::Crc(const uint8_t* data, int len) {
+    uint16_t crc = 0xFFFF;  // CRC-16/CCITT-FALSE
+    for (int i = 0; i < len; i++) {
+        crc ^= data[i] << 8;  // NOLINT
+        for (int b = 0; b < 8; b++) {  // NOLINT
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;  // NOLINT
+        }
+    }
+    return crc;
+}
+
+bool Nvm::IsValid(const uint8_t* slot) {
+    Header header;
+    memcpy(&header, slot, sizeof(header));
+    return header.magic == kMagic && header.length <= kMaxData &&
+           header.crc == Crc(slot + kHeaderSize, header.length);
+}
+
+bool Nvm::Load(void* data, int len) {
+    slot_ = -1;
+    for (int i = 0; i < kSlots; i++) {
+        if (!IsValid(Slot(i))) {
+            continue;
+        }
+        Header header;
+        memcpy(&header, Slot(i), sizeof(header));
+        if (slot_ < 0 ||
+            static_cast<int32_t>(header.sequence - sequence_) > 0) {
+            slot_     = i;
+            sequence_ = header.sequence;
+        }
+    }
+    if (slot_ < 0) {
+        return false;
+    }
+
+    Header header;
+    memcpy(&header, Slot(slot_), sizeof(header));
+    if (header.length != len) {
+        return false;  // layout changed, ignore the old record
+    }
+    memcpy(data, Slot(slot_) + kHeaderSize, len);
+    return true;
+}
+
+bool Nvm::Save(const void* data, int len) {
+    static_assert(sizeof(Header) == kHeaderSize, "unexpected header size");
+    if (len > kMaxData) {
+        return false;
+    }
+    uint8_t buffer[kSlotSize];
+    memset(buffer, 0xFF, sizeof(buffer));  // NOLINT
+    Header header = {kMagic,
+                     sequence_ + 1,
+                     static_cast<uint16_t>(len),
+                     Crc(static_cast<const uint8_t*>(data), len)};
+    memcpy(buffer, &header, sizeof(header));
+    memcpy(buffer + kHeaderSize, data, len);
+
+    int slot = (slot_ + 1) % kSlots;
+    for (int row = 0; row < kSlotSize / kRowSize; row++) {
+        EraseRow(Slot(slot) + row * kRowSize);
+    }
+    for (int page = 0; page < kSlotSize / kPageSize; page++) {
+        WritePage(Slot(slot) + page * kPageSize, buffer + page * kPageSize);
+    }
+    if (!IsValid(Slot(slot))) {
+        return false;
+    }
+    slot_     = slot;
+    sequence_ = header.sequence;
+    return true;
+}
+
+static void WaitReady() {
+    while (NVMCTRL->INTFLAG.bit.READY == 0) {
+    }
+}
+
+void Nvm::EraseRow(const uint8_t* row) {
+    NVMCTRL->STATUS.reg |= NVMCTRL_STATUS_MASK;  // clear the error flags
+    NVMCTRL->ADDR.reg  = reinterpret_cast<uintptr_t>(row) / 2;
+    NVMCTRL->CTRLA.reg = NVMCTRL_CTRLA_CMDEX_KEY | NVMCTRL_CTRLA_CMD_ER;
+    WaitReady();
+}
+
+void Nvm::WritePage(const uint8_t* page, const uint8_t* data) {
+    NVMCTRL->CTRLB.bit.MANW = 1;
+    NVMCTRL->CTRLA.reg      = NVMCTRL_CTRLA_CMDEX_KEY | NVMCTRL_CTRLA_CMD_PBC;
+    WaitReady();
+
+    // The page buffer must be written 32 bits at a time
+    auto* dst = reinterpret_cast<volatile uint32_t*>(  // NOLINT
+        const_cast<uint8_t*>(page));                  // NOLINT
+    for (int i = 0; i < kPageSize / 4; i++) {
+        uint32_t word;
+        memcpy(&word, data + i * 4, sizeof(word));
+        dst[i] = word;  // NOLINT
+    }
+
+    NVMCTRL->CTRLA.reg = NVMCTRL_CTRLA_CMDEX_KEY | NVMCTRL_CTRLA_CMD_WP;
+    WaitReady();
+}
@@ -0,0 +1,56 @@
+/**
+ ******************************************************************************
+ * @file        : nvm.hpp
+ * @brief       : Non-volatile storage in flash
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Non-volatile storage of one record in the SAMD21 flash. The reserved area
+ * is a ring of kSlots slots of two flash rows: each save goes to the slot
+ * following the last one, with an increasing sequence number and a CRC,
+ * so the erase cycles are spread over all the slots. At boot, the valid
+ * record with the highest sequence number wins.
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+class Nvm {
+   public:
+    static const int kRowSize    = 256;  // 4 pages of 64 bytes
+    static const int kPageSize   = 64;
+    static const int kSlotSize   = 2 * kRowSize;
+    static const int kSlots      = 16;
+    static const int kHeaderSize = 12;
+    static const int kMaxData    = kSlotSize - kHeaderSize;
+
+    Nvm();
+    // Load the latest record, return false if there is none
+    bool Load(void* data, int len);
+    bool Save(const void* data, int len);
+
+   private:
+    struct Header {
+        uint32_t magic;
+        uint32_t sequence;
+        uint16_t length;
+        uint16_t crc;
+    };
+
+    static const uint8_t* Slot(int slot);
+    static bool IsValid(const uint8_t* slot);
+    static uint16_t Crc(const uint8_t* data, int len);
+    static void EraseRow(const uint8_t* row);
+    static void WritePage(const uint8_t* page, const uint8_t* data);
+
+    int slot_;  // slot of the latest record, -1 if none
+    uint32_t sequence_;
+};
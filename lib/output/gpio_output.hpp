@@ -0,0 +1,89 @@
+/**
+ ******************************************************************************
+ * @file        : gpio_output.hpp
+ * @brief       : Coil outputs on GPIO pins
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Coil outputs on GPIO pins. The Feather M0 pins of the lines are given as
+ * template arguments and mapped to PORT/bit at compile time. A flush is one
+ * OUTSET and one OUTCLR write per port, so it is interrupt safe.
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+#include "gpio.hpp"
+#include "output.hpp"
+
+template <int... Pins>
+class GpioOutput : public CoilOutput {
+   public:
+    static const int kLines = sizeof...(Pins);
+
+    GpioOutput() : CoilOutput(kLines) {
+        static_assert(kLines <= kMaxLines, "too many lines");
+        static_assert(ValidPins(), "not a Feather M0 pin");
+        static_assert(__builtin_popcount(LineMask(0)) +
+                              __builtin_popcount(LineMask(1)) ==
+                          kLines,
+                      "pins must all be different");
+    }
+
+    void Begin() override {
+        for (int port = 0; port < kPorts; port++) {
+            if (LineMask(port) != 0) {
+                ConfigureOutputs(port, LineMask(port));
+            }
+        }
+    }
+
+    void Flush() override {
+        uint8_t image[kMaxLines / 8];
+        Snapshot(image);
+        uint32_t set[kPorts] = {0, 0};
+        for (int line = 0; line < kLines; line++) {
+            if ((image[line / 8] & (1 << (line % 8))) != 0) {  // NOLINT
+                set[kLinePins[line].port] |= kLinePins[line].Mask();
+            }
+        }
+        for (int port = 0; port < kPorts; port++) {
+            if (LineMask(port) != 0) {
+                PORT->Group[port].OUTSET.reg = set[port];
+                PORT->Group[port].OUTCLR.reg = LineMask(port) & ~set[port];
+            }
+        }
+    }
+
+    bool InterruptSafe() const override { return true; }
+
+   private:
+    static constexpr PortPin kLinePins[] = {FeatherPin(Pins)...};
+
+    static constexpr uint32_t LineMask(int port) {
+        uint32_t mask = 0;
+        for (PortPin pin : kLinePins) {
+            if (pin.port == port) {
+                mask |= pin.Mask();
+            }
+        }
+        return mask;
+    }
+
+    static constexpr bool ValidPins() {
+        for (PortPin pin : kLinePins) {
+            if (!pin.IsValid()) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
@@ -0,0 +1,75 @@
+/**
+ ******************************************************************************
+ * @file        : mcp23017_output.hpp
+ * @brief       : Coil outputs on MCP23017 expanders
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Coil outputs on `Chips` MCP23017 I2C expanders, at consecutive addresses
+ * from `address`. Lines 0-7 are GPA0-7 of the first chip, lines 8-15 its
+ * GPB0-7, and so on. A flush writes OLATA and OLATB of each chip in a single
+ * I2C transaction (sequential register addressing, IOCON.BANK = 0).
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+#include "output.hpp"
+
+template <class Bus, int Chips>
+class Mcp23017Output : public CoilOutput {
+   public:
+    static const int kLines           = 16 * Chips;
+    static const uint8_t kBaseAddress = 0x20;
+
+    explicit Mcp23017Output(Bus* bus, uint8_t address = kBaseAddress)
+        : CoilOutput(kLines), bus_(bus), address_(address) {
+        static_assert(kLines <= kMaxLines, "too many lines");
+        static_assert(Chips <= 8, "8 addresses at most");  // NOLINT
+    }
+
+    void Begin() override {
+        bus_->begin();
+        for (int chip = 0; chip < Chips; chip++) {
+            Write(chip, kOlatA, 0, 0);   // low first...
+            Write(chip, kIodirA, 0, 0);  // ...then outputs
+        }
+    }
+
+    void Flush() override {
+        uint8_t image[kMaxLines / 8];
+        Snapshot(image);
+        for (int chip = 0; chip < Chips; chip++) {
+            Write(chip, kOlatA, image[2 * chip], image[2 * chip + 1]);
+        }
+    }
+
+    int Failures() const { return failures_; }  // I2C errors
+
+   private:
+    static const uint8_t kIodirA = 0x00;
+    static const uint8_t kOlatA  = 0x14;
+
+    // Write a register pair (A, then B)
+    void Write(int chip, uint8_t reg, uint8_t a, uint8_t b) {
+        bus_->beginTransmission(static_cast<uint8_t>(address_ + chip));
+        bus_->write(reg);
+        bus_->write(a);
+        bus_->write(b);
+        if (bus_->endTransmission() != 0) {
+            failures_++;
+        }
+    }
+
+    Bus* bus_;
+    uint8_t address_;
+    int failures_ = 0;
+};
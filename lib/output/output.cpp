@@ -0,0 +1,55 @@
+/**
+ ******************************************************************************
+ * @file        : output.cpp
+ * @brief       : Coil outputs
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Coil outputs
+ ******************************************************************************
+ */
+
+#include "output.hpp"
+
+CoilOutput::CoilOutput(int lines) : lines_(min(lines, kMaxLines)) {
+    Clear();
+}
+
+void CoilOutput::Set(int line, bool on) {
+    if (line < 0 || line >= lines_) {
+        return;
+    }
+    uint8_t mask = 1 << (line % 8);  // NOLINT
+    // Also called from the pulse engine interrupt
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (on) {
+        image_[line / 8] = image_[line / 8] | mask;  // NOLINT
+    } else {
+        image_[line / 8] = image_[line / 8] & ~mask;  // NOLINT
+    }
+    __set_PRIMASK(primask);
+}
+
+void CoilOutput::Clear() {
+    for (int i = 0; i < kMaxLines / 8; i++) {  // NOLINT
+        image_[i] = 0;
+    }
+}
+
+int CoilOutput::Lines() const { return lines_; }
+
+void CoilOutput::Snapshot(uint8_t* image) const {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    for (int i = 0; i < kMaxLines / 8; i++) {  // NOLINT
+        image[i] = image_[i];
+    }
+    __set_PRIMASK(primask);
+}
@@ -0,0 +1,55 @@
+/**
+ ******************************************************************************
+ * @file        : output.hpp
+ * @brief       : Coil outputs
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Coil outputs. The coil lines are numbered from 0 (valve i uses lines 2i to
+ * open and 2i+1 to close) and kept in an image: Set() only changes the
+ * image, and Flush() writes all the lines to the hardware at once, in one
+ * bus transaction. Backends:
+ *   - GpioOutput: Feather M0 pins, one register write per port
+ *   - ShiftRegisterOutput: chained 74HC595 on SPI
+ *   - Mcp23017Output: MCP23017 I2C expanders
+ * The bus backends are templates on the bus class (SPIClass, TwoWire), so
+ * that they can be driven by a mock bus on the host.
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+class CoilOutput {
+   public:
+    static const int kMaxLines = 64;
+
+    explicit CoilOutput(int lines);
+
+    virtual void Begin() = 0;
+    // Write the image to the hardware
+    virtual void Flush() = 0;
+    // Whether Flush() may be called from an interrupt handler. Bus backends
+    // may not: the SPI bus is shared with the radio.
+    virtual bool InterruptSafe() const { return false; }
+
+    void Set(int line, bool on);
+    void Clear();  // all lines off
+    int Lines() const;
+
+   protected:
+    // Copy of the image (line i is bit i % 8 of byte i / 8), taken with the
+    // interrupts disabled
+    void Snapshot(uint8_t* image) const;
+
+   private:
+    int lines_;
+    volatile uint8_t image_[kMaxLines / 8];
+};
@@ -0,0 +1,66 @@
+/**
+ ******************************************************************************
+ * @file        : shift_register_output.hpp
+ * @brief       : Coil outputs on shift registers
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Coil outputs on `Chips` chained 74HC595 shift registers, on the SPI bus
+ * (MOSI to the data input of the first chip, SCK to the shift clocks) with
+ * a latch pin to the storage clocks. Line 0 is QA of the first chip, line 8
+ * QA of the second one, and so on. A flush shifts the whole chain in one SPI
+ * transaction and then latches it.
+ *
+ * The radio traffic also goes through the shift registers, but the outputs
+ * only change on the latch, after the whole image has been shifted in.
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <SPI.h>
+
+#include "output.hpp"
+
+template <class Bus, int Chips>
+class ShiftRegisterOutput : public CoilOutput {
+   public:
+    static const int kLines          = 8 * Chips;
+    static const uint32_t kFrequency = 4000000;  // Hz
+
+    ShiftRegisterOutput(Bus* bus, int latchPin)
+        : CoilOutput(kLines), bus_(bus), latchPin_(latchPin) {
+        static_assert(kLines <= kMaxLines, "too many lines");
+    }
+
+    void Begin() override {
+        pinMode(latchPin_, OUTPUT);
+        digitalWrite(latchPin_, LOW);
+        bus_->begin();
+        Flush();  // the outputs are undefined at power up
+    }
+
+    void Flush() override {
+        uint8_t image[kMaxLines / 8];
+        Snapshot(image);
+        bus_->beginTransaction(SPISettings(kFrequency, MSBFIRST, SPI_MODE0));
+        // The last chip of the chain is shifted first
+        for (int chip = Chips - 1; chip >= 0; chip--) {
+            bus_->transfer(image[chip]);
+        }
+        bus_->endTransaction();
+        digitalWrite(latchPin_, HIGH);
+        digitalWrite(latchPin_, LOW);
+    }
+
+   private:
+    Bus* bus_;
+    int latchPin_;
+};
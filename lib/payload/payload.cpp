@@ -17,26 +17,151 @@
 
 #include "payload.hpp"
 
-const int Payload::periods_[] = {
-    0, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, -2, -1};
+Payload::Payload(const uint8_t* data, int len)
+    : data_(data), len_(len), pos_(0), valid_(false) {
+    valid_ = Validate();
+    if (!IsLegacy()) {
+        pos_ = 1;  // skip the version
+    }
+}
+
+bool Payload::IsLegacy() const { return len_ == kLegacyLength; }
+
+bool Payload::IsValid() const { return valid_; }
+
+// Walk the whole frame once (every step consumes at least 2 bytes), so
+// that a malformed frame is rejected before any command is run.
+bool Payload::Validate() const {
+    if (IsLegacy()) {
+        return true;
+    }
+    if (len_ < 1 || data_[0] != kVersion) {
+        return false;
+    }
+    int pos = 1;
+    while (pos < len_) {
+        if (pos + 2 > len_) {
+            return false;
+        }
+        int len = data_[pos + 1];
+        if (len == 0 || pos + 2 + len > len_) {
+            return false;
+        }
+        pos += 2 + len;
+    }
+    return true;
+}
+
+bool Payload::Next(Command* command) {
+    if (!valid_) {
+        return false;
+    }
+    return IsLegacy() ? NextLegacy(command) : NextTLV(command);
+}
+
+bool Payload::NextLegacy(Command* command) {
+    while (pos_ < kLegacyNOfValves) {
+        int valve = pos_++;
+        int p     = GetPeriod(valve);  // NOLINT
+        if (p == 0) {
+            continue;
+        }
+        command->valve = valve;
+        command->data  = nullptr;
+        command->len   = 0;
+        if (p == -1) {
+            command->opcode = Command::kClose;
+            command->value  = 0;
+        } else {
+            command->opcode = Command::kOpen;
+            command->value  = p < 0 ? 0 : p * 60;  // minute to seconds NOLINT
+        }
+        return true;
+    }
+    return false;
+}
+
+bool Payload::NextTLV(Command* command) {
+    while (pos_ < len_) {
+        const uint8_t* value = data_ + pos_ + 2;
+        uint8_t opcode       = data_[pos_];
+        uint8_t len          = data_[pos_ + 1];
+        pos_ += 2 + len;
+
+        command->opcode = opcode;
+        command->valve  = 0;
+        command->value  = 0;
+        command->data   = value;
+        command->len    = len;
+        switch (opcode) {
+            case Command::kOpen:
+                if (len > 5) {  // NOLINT
+                    continue;
+                }
+                command->valve = value[0];
+                command->value = ReadLE(value + 1, len - 1);
+                return true;
+
+            case Command::kClose:
+                command->valve = value[0];
+                return true;
+
+            case Command::kSetUplinkInterval:
+            case Command::kQuery:
+            case Command::kSetTime:
+                if (len > 4) {  // NOLINT
+                    continue;
+                }
+                command->value = ReadLE(value, len);
+                return true;
+
+            case Command::kSetSchedule:
+                return true;
 
-// NOLINTNEXTLINE
-void Payload::SetPayload(u_int8_t* payload, int len) {
-    if (len > (int)sizeof(payload_)) {
-        len = sizeof(payload_);
+            case Command::kSequence:
+                if (len > 2) {
+                    continue;
+                }
+                command->value = ReadLE(value, len);
+                return true;
+
+            case Command::kSetClassB:
+                if (len > 1) {
+                    continue;
+                }
+                command->value = value[0];
+                return true;
+
+            default:
+                continue;  // unknown opcode, skipped
+        }
+    }
+    return false;
+}
+
+bool Payload::Sequence(uint16_t* sequence) const {
+    if (IsLegacy()) {
+        return false;
+    }
+    Payload payload(data_, len_);
+    Command command;
+    while (payload.Next(&command)) {
+        if (command.opcode == Command::kSequence) {
+            *sequence = command.value;
+            return true;
+        }
     }
-    memcpy(payload_, payload, len);
+    return false;
 }
 
-// NOLINTNEXTLINE
-int Payload::GetPeriod(int index) {
+int Payload::GetPeriod(int index) const {
     int i = index / 2;  // NOLINT
-    if (i < 0 || i >= (int)sizeof(payload_)) {
+    if (i < 0 || i >= len_) {
         return -1;
     }
-    uint8_t p = payload_[i];  // NOLINT
+    uint8_t p = data_[i];  // NOLINT
     if (index % 2 == 0) {
         p = p >> 4;
     }
-    return periods_[p & 0x0F];  // NOLINT
+    return kPeriods[p & 0x0F];  // NOLINT
 }
@@ -11,7 +11,10 @@
  * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
  ******************************************************************************
  * @details
- * Payload decoder
+ * Payload decoder. The decoder works in place on the received frame and
+ * yields one command at a time.
+ *
+ * The formats are described in the codec library.
  ******************************************************************************
  */
 
@@ -19,13 +22,28 @@
 
 #include <Arduino.h>
 
-class Payload {
+#include "codec.hpp"
+
+class Payload : public DownlinkFormat {
    public:
-    Payload() = default;
-    void SetPayload(u_int8_t* payload, int len);
-    int GetPeriod(int index);
+    Payload(const uint8_t* data, int len);
+
+    bool IsLegacy() const;
+    bool IsValid() const;
+    // Decode the next command, return false at the end of the frame
+    bool Next(Command* command);
+    // Find the sequence number of the frame, return false if there is none
+    bool Sequence(uint16_t* sequence) const;
+
+    int GetPeriod(int index) const;  // legacy format, in minutes
 
    private:
-    static const int periods_[16];
-    u_int8_t payload_[4];
+    bool Validate() const;
+    bool NextLegacy(Command* command);
+    bool NextTLV(Command* command);
+
+    const uint8_t* data_;
+    int len_;
+    int pos_;  // byte (TLV) or valve (legacy) index
+    bool valid_;
 };
@@ -0,0 +1,129 @@
+/**
+ ******************************************************************************
+ * @file        : profiler.cpp
+ * @brief       : Energy and timing profiler
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Energy and timing profiler
+ ******************************************************************************
+ */
+
+#include "profiler.hpp"
+
+#include "codec.hpp"
+
+// Typical current of each phase in uA, for a Feather M0 LoRa, on top of the
+// phases that contain it. To be calibrated for the actual board and valves.
+static const uint32_t kCurrent[Profiler::kPhases] = {
+    7000,    // kAwake: SAMD21 at 48 MHz, radio in sleep
+    60,      // kSleep: standby, RTC running
+    0,       // kSend: CPU, already counted by kAwake
+    1600,    // kRadio: radio in standby or receiving
+    44000,   // kTx: PA_BOOST at 14 dBm
+    200000,  // kPulse: valve coil
+    2000,    // kIdle: SAMD21 idle, woken by the SysTick every ms
+};
+
+static const uint64_t kUsPerHour = 3600ULL * 1000 * 1000;
+
+Profiler Profile;  // NOLINT
+
+static void SyncTC4() {
+    while (TC4->COUNT32.STATUS.bit.SYNCBUSY) {
+    }
+}
+
+Profiler::Profiler() : count_{}, time_{}, start_{}, running_(0) {}
+
+void Profiler::Begin() {
+    PM->APBCMASK.reg |= PM_APBCMASK_TC4 | PM_APBCMASK_TC5;
+    GCLK->CLKCTRL.reg = static_cast<uint16_t>(
+        GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN_GCLK3 | GCLK_CLKCTRL_ID_TC4_TC5);
+    while (GCLK->STATUS.bit.SYNCBUSY) {
+    }
+
+    TC4->COUNT32.CTRLA.reg &= ~TC_CTRLA_ENABLE;
+    SyncTC4();
+    TC4->COUNT32.CTRLA.reg = TC_CTRLA_MODE_COUNT32 | TC_CTRLA_PRESCALER_DIV8;
+    SyncTC4();
+    // Continuous read synchronization of COUNT, so that Now() does not wait
+    TC4->COUNT32.READREQ.reg = TC_READREQ_RCONT | TC_READREQ_ADDR(0x10);
+    TC4->COUNT32.CTRLA.reg |= TC_CTRLA_ENABLE;
+    SyncTC4();
+}
+
+uint32_t Profiler::Now() const { return TC4->COUNT32.COUNT.reg; }
+
+void Profiler::Start(Phase phase) {
+    start_[phase] = Now();
+    running_ |= 1 << phase;
+}
+
+void Profiler::Stop(Phase phase) {
+    if ((running_ & (1 << phase)) == 0) {
+        return;
+    }
+    running_ &= ~(1 << phase);
+    Add(phase, Now() - start_[phase]);
+}
+
+void Profiler::Add(Phase phase, uint32_t us) {
+    count_[phase] = count_[phase] + 1;
+    time_[phase]  = time_[phase] + us;
+}
+
+uint32_t Profiler::Count(Phase phase) const {
+    noInterrupts();
+    uint32_t count = count_[phase];
+    interrupts();
+    return count;
+}
+
+uint64_t Profiler::Time(Phase phase) const {
+    noInterrupts();
+    uint64_t us = time_[phase];
+    interrupts();
+    return us / kTicksPerMs;
+}
+
+uint32_t Profiler::Charge(Phase phase) const {
+    noInterrupts();
+    uint64_t us = time_[phase];
+    interrupts();
+    return us * kCurrent[phase] / kUsPerHour;
+}
+
+int Profiler::Encode(uint8_t* buffer, int size, bool* complete) const {
+    if (complete != nullptr) {
+        *complete = false;
+    }
+    if (size < 1) {
+        return 0;
+    }
+    int len       = 0;
+    buffer[len++] = kVersion;
+    int i         = 0;
+    for (; i < kPhases; i++) {
+        auto phase = static_cast<Phase>(i);
+        uint8_t fields[kMaxFrameSize / kPhases];
+        int n = Varint::Put(fields, sizeof(fields), Count(phase));
+        n += Varint::Put(fields + n, sizeof(fields) - n, Time(phase));
+        n += Varint::Put(fields + n, sizeof(fields) - n, Charge(phase));
+        if (len + n > size) {
+            break;  // the decoder takes the phases present
+        }
+        memcpy(buffer + len, fields, n);
+        len += n;
+    }
+    if (complete != nullptr) {
+        *complete = i == kPhases;
+    }
+    return len;
+}
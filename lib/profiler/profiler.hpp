@@ -0,0 +1,83 @@
+/**
+ ******************************************************************************
+ * @file        : profiler.hpp
+ * @brief       : Energy and timing profiler
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Energy and timing profiler. The time spent in each phase is measured with
+ * TC4/TC5, chained as a free-running 32-bit counter at 1 MHz (GCLK3, the
+ * 8 MHz internal oscillator, divided by 8), and accumulated with the number
+ * of occurrences of the phase. A phase must be shorter than the wrap of the
+ * counter (71 minutes).
+ *
+ * The counter stops in deep sleep, so the sleep time and the coil pulses
+ * (measured by the pulse engine) are added as durations. The time on air is
+ * computed from the frame length.
+ *
+ * The charge of each phase is estimated from the typical current drawn on
+ * top of the phases that contain it (see kCurrent in profiler.cpp): kSend is
+ * part of kAwake, kRadio of kAwake and kIdle, kTx of kRadio.
+ *
+ * Diagnostic frame (Encode), totals since the reset:
+ *   byte 0 : version (kVersion)
+ *   then, for each phase: count, time in ms and charge in uAh, as LEB128
+ *   varints. The last phases are left out if the frame is too short.
+ *   The firmware may append more fields once every phase is in.
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+class Profiler {
+   public:
+    enum Phase {
+        kAwake,  // main loop, not sleeping
+        kSleep,
+        kSend,   // SendLoraPacket()
+        kRadio,  // EV_TXSTART to the end of the RX windows
+        kTx,     // time on air
+        kPulse,  // coil pulses
+        kIdle    // CPU idle, waiting for the radio
+    };
+
+    static const int kPhases          = 7;
+    static const uint8_t kVersion     = 1;
+    static const int kMaxFrameSize    = 1 + kPhases * (5 + 10 + 5);
+    static const uint32_t kTicksPerMs = 1000;
+
+    Profiler();
+    void Begin();
+
+    // Free-running counter, in us
+    uint32_t Now() const;
+    void Start(Phase phase);
+    // Ignored if the phase is not running
+    void Stop(Phase phase);
+    // Add an occurrence of the phase, measured elsewhere. Interrupt safe for
+    // kPulse only.
+    void Add(Phase phase, uint32_t us);
+
+    uint32_t Count(Phase phase) const;
+    uint64_t Time(Phase phase) const;    // ms
+    uint32_t Charge(Phase phase) const;  // uAh
+
+    // `complete` is set if every phase fits
+    int Encode(uint8_t* buffer, int size, bool* complete = nullptr) const;
+
+   private:
+    volatile uint32_t count_[kPhases];
+    volatile uint64_t time_[kPhases];  // us
+    uint32_t start_[kPhases];
+    uint8_t running_;  // bitmask of the running phases
+};
+
+extern Profiler Profile;  // NOLINT
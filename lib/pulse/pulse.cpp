@@ -0,0 +1,145 @@
+/**
+ ******************************************************************************
+ * @file        : pulse.cpp
+ * @brief       : Coil pulse engine
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Coil pulse engine
+ ******************************************************************************
+ */
+
+#include "pulse.hpp"
+
+#include <Arduino.h>
+
+// TC3 is clocked by GCLK0 (48 MHz) / 16, so 3000 ticks are 1 ms
+static const uint16_t kTicksPerMs = 3000;
+
+PulseEngine Pulses;  // NOLINT
+
+// NOLINTNEXTLINE
+void TC3_Handler() { Pulses.OnTick(); }
+
+static void SyncTC3() {
+    while (TC3->COUNT16.STATUS.bit.SYNCBUSY) {
+    }
+}
+
+void PulseEngine::Begin(CoilOutput* output) {
+    output_ = output;
+    PM->APBCMASK.reg |= PM_APBCMASK_TC3;
+    GCLK->CLKCTRL.reg = static_cast<uint16_t>(
+        GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN_GCLK0 | GCLK_CLKCTRL_ID_TCC2_TC3);
+    while (GCLK->STATUS.bit.SYNCBUSY) {
+    }
+
+    TC3->COUNT16.CTRLA.reg &= ~TC_CTRLA_ENABLE;
+    SyncTC3();
+    TC3->COUNT16.CTRLA.reg = TC_CTRLA_MODE_COUNT16 | TC_CTRLA_WAVEGEN_MFRQ |
+                             TC_CTRLA_PRESCALER_DIV16;
+    SyncTC3();
+    TC3->COUNT16.CC[0].reg = kTicksPerMs - 1;
+    SyncTC3();
+    TC3->COUNT16.INTENSET.reg = TC_INTENSET_MC0;
+
+    NVIC_ClearPendingIRQ(TC3_IRQn);
+    NVIC_EnableIRQ(TC3_IRQn);
+}
+
+void PulseEngine::StartTimer() {
+    TC3->COUNT16.COUNT.reg = 0;
+    SyncTC3();
+    TC3->COUNT16.CTRLA.reg |= TC_CTRLA_ENABLE;
+    SyncTC3();
+}
+
+void PulseEngine::StopTimer() {
+    TC3->COUNT16.CTRLA.reg &= ~TC_CTRLA_ENABLE;
+    SyncTC3();
+}
+
+bool PulseEngine::Start(int coil,
+                        uint16_t width,
+                        Callback done,
+                        void* context,
+                        PortPin sense,
+                        uint16_t minWidth) {
+    noInterrupts();
+    if (count_ == kQueueSize) {
+        interrupts();
+        return false;
+    }
+    queue_[(head_ + count_) % kQueueSize] = {
+        coil, sense, minWidth, width, done, context};
+    count_ = count_ + 1;
+    if (count_ == 1) {
+        Fire();
+    }
+    interrupts();
+    Poll();
+    return true;
+}
+
+bool PulseEngine::Busy() const { return count_ != 0 || dirty_; }
+
+void PulseEngine::Poll() {
+    if (dirty_) {
+        dirty_ = false;
+        output_->Flush();
+    }
+}
+
+void PulseEngine::Drive(int coil, bool on) {
+    output_->Set(coil, on);
+    if (output_->InterruptSafe()) {
+        output_->Flush();
+    } else {
+        dirty_ = true;
+    }
+}
+
+// Drive the coil of the job at the head of the queue
+void PulseEngine::Fire() {
+    elapsed_ = 0;
+    Drive(queue_[head_].coil, true);
+    StartTimer();
+}
+
+void PulseEngine::OnTick() {
+    TC3->COUNT16.INTFLAG.reg = TC_INTFLAG_MC0;
+    if (count_ == 0) {
+        StopTimer();
+        return;
+    }
+    const Job& job = queue_[head_];
+    elapsed_       = elapsed_ + 1;
+    bool sensed    = false;
+    if (job.sense.IsValid() && elapsed_ >= job.minWidth) {
+        sensed = ReadPin(job.sense);
+    }
+    if (!sensed && elapsed_ < job.width) {
+        return;
+    }
+
+    Drive(job.coil, false);
+    Callback done  = job.done;
+    void* context  = job.context;
+    uint16_t width = elapsed_;
+    head_          = (head_ + 1) % kQueueSize;
+    count_         = count_ - 1;
+    if (count_ > 0) {
+        Fire();
+    } else {
+        StopTimer();
+    }
+    if (done != nullptr) {
+        done(context, width, sensed);
+    }
+}
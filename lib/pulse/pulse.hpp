@@ -0,0 +1,84 @@
+/**
+ ******************************************************************************
+ * @file        : pulse.hpp
+ * @brief       : Coil pulse engine
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Non-blocking coil pulse engine. Pulses are queued and played one after
+ * the other (so that two coils are never driven at the same time). The end
+ * of a pulse is handled by the TC3 interrupt, ticking every millisecond
+ * while a pulse is running, so Start() returns immediately.
+ *
+ * Coils are lines of a CoilOutput. If its flush is not interrupt safe, the
+ * interrupt handler only updates the image of the lines, and Poll() writes
+ * it from the main loop (the pulses are then longer by the loop latency).
+ *
+ * A pulse can be given a sense input (typically a comparator on the coil
+ * current) which goes high once the latch has flipped: the pulse then ends
+ * early, but never before `minWidth` ms.
+ *
+ * The completion callback is called from the interrupt handler with the
+ * actual duration of the pulse: it must be short and must not log nor touch
+ * LMIC.
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+#include "gpio.hpp"
+#include "output.hpp"
+
+class PulseEngine {
+   public:
+    typedef void (*Callback)(void* context, uint16_t width, bool sensed);
+    static const int kQueueSize = 16;
+
+    PulseEngine() = default;
+    void Begin(CoilOutput* output);
+
+    // Queue a pulse of at most `width` ms on line `coil`. Returns false if
+    // the queue is full.
+    bool Start(int coil,
+               uint16_t width,
+               Callback done,
+               void* context,
+               PortPin sense     = kNoPin,
+               uint16_t minWidth = 0);
+    bool Busy() const;
+    void Poll();  // write the coil lines, from the main loop
+
+    void OnTick();  // called by TC3_Handler
+
+   private:
+    struct Job {
+        int coil;
+        PortPin sense;
+        uint16_t minWidth;
+        uint16_t width;
+        Callback done;
+        void* context;
+    };
+
+    void Fire();
+    void Drive(int coil, bool on);
+    static void StartTimer();
+    static void StopTimer();
+
+    CoilOutput* output_ = nullptr;
+    Job queue_[kQueueSize];
+    volatile int head_    = 0;
+    volatile int count_   = 0;
+    volatile int elapsed_ = 0;      // ms
+    volatile bool dirty_  = false;  // lines to write by Poll()
+};
+
+extern PulseEngine Pulses;  // NOLINT
@@ -0,0 +1,102 @@
+/**
+ ******************************************************************************
+ * @file        : recovery.cpp
+ * @brief       : Transmission failure recovery
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Transmission failure recovery
+ ******************************************************************************
+ */
+
+#include "recovery.hpp"
+
+TxRecovery::TxRecovery() : failures_(0) {
+    for (int i = 0; i < kStages; i++) {
+        counts_[i] = 0;
+    }
+}
+
+TxRecovery::Stage TxRecovery::OnTimeout() {
+    failures_++;
+    Stage stage = kChipReset;
+    if (failures_ <= kMaxRetries) {
+        stage = kRetry;
+    } else if (failures_ == kMaxRetries + 1) {
+        stage = kMacReset;
+    }
+    counts_[kCancel]++;
+    counts_[stage]++;
+    return stage;
+}
+
+void TxRecovery::OnSuccess() { failures_ = 0; }
+
+uint32_t TxRecovery::Backoff() const {
+    int shift        = constrain(failures_ - 1, 0, 8);  // NOLINT
+    uint32_t backoff = kBaseBackoff << shift;
+    if (backoff > kMaxBackoff) {
+        backoff = kMaxBackoff;
+    }
+    // Up to 50% of jitter, so that devices hit by the same outage do not
+    // retry in lockstep
+    return backoff + random(backoff / 2 + 1);
+}
+
+uint16_t TxRecovery::Count(Stage stage) const { return counts_[stage]; }
+
+void TxRecovery::SetCount(Stage stage, uint16_t count) {
+    counts_[stage] = count;
+}
+
+// Watchdog clock: 32768 Hz / 2^(kWatchdogDiv + 1) = 16 Hz
+static const int kWatchdogGclk = 4;  // GCLK_CLKCTRL_GEN_GCLK4
+static const int kWatchdogDiv  = 10;
+
+void WatchdogBegin() {
+    GCLK->GENDIV.reg =
+        GCLK_GENDIV_ID(kWatchdogGclk) | GCLK_GENDIV_DIV(kWatchdogDiv);
+    while (GCLK->STATUS.bit.SYNCBUSY) {
+    }
+    GCLK->GENCTRL.reg = GCLK_GENCTRL_ID(kWatchdogGclk) |
+                        GCLK_GENCTRL_SRC_OSCULP32K | GCLK_GENCTRL_GENEN |
+                        GCLK_GENCTRL_DIVSEL | GCLK_GENCTRL_RUNSTDBY;
+    while (GCLK->STATUS.bit.SYNCBUSY) {
+    }
+    GCLK->CLKCTRL.reg = GCLK_CLKCTRL_ID_WDT | GCLK_CLKCTRL_CLKEN |
+                        GCLK_CLKCTRL_GEN_GCLK4;
+    while (GCLK->STATUS.bit.SYNCBUSY) {
+    }
+
+    // The configuration is locked while the watchdog is enabled
+    WDT->CTRL.reg = 0;
+    while (WDT->STATUS.bit.SYNCBUSY) {
+    }
+    WDT->CONFIG.reg = WDT_CONFIG_PER_16K;
+    WDT->CTRL.reg   = WDT_CTRL_ENABLE;
+    while (WDT->STATUS.bit.SYNCBUSY) {
+    }
+}
+
+void WatchdogFeed() {
+    // A clear takes a few watchdog cycles to synchronize: the one still
+    // running is recent enough
+    if (WDT->STATUS.bit.SYNCBUSY == 0) {
+        WDT->CLEAR.reg = WDT_CLEAR_CLEAR_KEY;
+    }
+}
+
+void WatchdogReset() {
+    // Any value but the key resets the chip at once
+    while (WDT->STATUS.bit.SYNCBUSY) {
+    }
+    WDT->CLEAR.reg = 0;
+    for (;;) {
+    }
+}
@@ -0,0 +1,67 @@
+/**
+ ******************************************************************************
+ * @file        : recovery.hpp
+ * @brief       : Transmission failure recovery
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Transmission failure recovery. Every transmission timeout cancels the
+ * pending LMIC job. The first kMaxRetries consecutive timeouts are retried
+ * after an exponential backoff with random jitter. The next one resets the
+ * MAC (keeping the session), and only if that does not help either, the
+ * chip is reset by the watchdog. A successful transmission starts over.
+ *
+ * The watchdog also runs all the time, in standby as well, with a period
+ * longer than the longest sleep: the main loop feeds it, and a firmware
+ * stuck anywhere else is reset.
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+class TxRecovery {
+   public:
+    // Every timeout is counted as kCancel, and as the stage applied
+    enum Stage { kCancel, kRetry, kMacReset, kChipReset };
+
+    static const int kStages           = 4;
+    static const int kMaxRetries       = 3;
+    static const uint32_t kBaseBackoff = 30;       // s
+    static const uint32_t kMaxBackoff  = 15 * 60;  // s
+
+    TxRecovery();
+
+    // Return the stage to apply after a transmission timeout
+    Stage OnTimeout();
+    void OnSuccess();
+    // Delay before the next attempt, in seconds, with jitter
+    uint32_t Backoff() const;
+
+    uint16_t Count(Stage stage) const;
+    void SetCount(Stage stage, uint16_t count);  // restored after a reset
+
+   private:
+    int failures_;  // consecutive
+    uint16_t counts_[kStages];
+};
+
+// The watchdog is clocked by GCLK4, the ultra low power 32 kHz oscillator
+// divided by 2048, which keeps running in standby. Its longest period,
+// 16384 cycles, then lasts kWatchdogTimeout.
+static const uint32_t kWatchdogTimeout = 1024;  // s
+
+// Start the watchdog, then feed it more often than kWatchdogTimeout
+void WatchdogBegin();
+void WatchdogFeed();
+
+// Reset the chip through the watchdog, which leaves the reset cause in
+// PM->RCAUSE. Needs WatchdogBegin().
+[[noreturn]] void WatchdogReset();
@@ -0,0 +1,101 @@
+/**
+ ******************************************************************************
+ * @file        : schedule.cpp
+ * @brief       : Irrigation schedule
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Irrigation schedule
+ ******************************************************************************
+ */
+
+#include "schedule.hpp"
+
+static const uint32_t kSecondsPerDay = 24 * 60 * 60;
+static const int kDaysPerWeek        = 7;
+static const int kY2kWeekday         = 5;  // 1 January 2000 was a Saturday
+static const int kMinEntryLength     = 6;
+static const int kMaxEntryLength     = 9;
+
+Schedule::Schedule() : entries_{}, next_{} {
+    for (int i = 0; i < kMaxEntries; i++) {
+        next_[i] = kNever;
+    }
+}
+
+int Schedule::Parse(const uint8_t* data, int len, Entry* entry) {
+    if (len < kMinEntryLength || len > kMaxEntryLength ||
+        data[0] >= kMaxEntries) {
+        return -1;
+    }
+    entry->valve    = data[1];
+    entry->days     = data[2] & 0x7F;            // NOLINT
+    entry->start    = data[3] | (data[4] << 8);  // NOLINT
+    entry->duration = 0;
+    for (int i = len - 1; i >= 5; i--) {  // NOLINT
+        entry->duration = (entry->duration << 8) | data[i];  // NOLINT
+    }
+    if (entry->start >= 24 * 60) {  // NOLINT
+        return -1;
+    }
+    return data[0];
+}
+
+void Schedule::Set(int slot, const Entry& entry, uint32_t now) {
+    if (slot < 0 || slot >= kMaxEntries) {
+        return;
+    }
+    entries_[slot] = entry;
+    next_[slot]    = NextFiring(entry, now);
+}
+
+const Schedule::Entry& Schedule::Get(int slot) const { return entries_[slot]; }
+
+void Schedule::Rebase(uint32_t now) {
+    for (int i = 0; i < kMaxEntries; i++) {
+        next_[i] = NextFiring(entries_[i], now);
+    }
+}
+
+uint32_t Schedule::Next() const {
+    uint32_t next = kNever;
+    for (int i = 0; i < kMaxEntries; i++) {
+        next = min(next, next_[i]);
+    }
+    return next;
+}
+
+int Schedule::PopDue(uint32_t now) {
+    for (int i = 0; i < kMaxEntries; i++) {
+        if (next_[i] != kNever && next_[i] <= now) {
+            next_[i] = NextFiring(entries_[i], now + 1);
+            return i;
+        }
+    }
+    return -1;
+}
+
+// First firing time at or after `now`
+uint32_t Schedule::NextFiring(const Entry& entry, uint32_t now) {
+    if (entry.days == 0 || entry.duration == 0) {
+        return kNever;
+    }
+    uint32_t day = now / kSecondsPerDay;
+    for (int k = 0; k <= kDaysPerWeek; k++) {
+        int weekday = (day + k + kY2kWeekday) % kDaysPerWeek;
+        if ((entry.days & (1 << weekday)) == 0) {
+            continue;
+        }
+        uint32_t t = (day + k) * kSecondsPerDay + entry.start * 60;  // NOLINT
+        if (t >= now) {
+            return t;
+        }
+    }
+    return kNever;
+}
@@ -0,0 +1,66 @@
+/**
+ ******************************************************************************
+ * @file        : schedule.hpp
+ * @brief       : Irrigation schedule
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Irrigation schedule. Each entry opens a valve on given days of the week,
+ * at a given time of the day, for a given duration. Only the next firing
+ * time of each entry is computed, when the entry is set and when it fires,
+ * so nothing has to be evaluated between two events.
+ *
+ * Times are local times, in seconds since 1 January 2000.
+ *
+ * Entry encoding (set-schedule downlink command):
+ *   byte 0    : slot (0 .. kMaxEntries - 1)
+ *   byte 1    : valve
+ *   byte 2    : days, bit 0 = Monday .. bit 6 = Sunday (0 clears the slot)
+ *   bytes 3-4 : start time in minutes after midnight, LSB first
+ *   bytes 5.. : duration in seconds, 1 to 4 bytes, LSB first
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+class Schedule {
+   public:
+    struct Entry {
+        uint8_t valve;
+        uint8_t days;       // bit 0 = Monday .. bit 6 = Sunday
+        uint16_t start;     // minutes after midnight
+        uint32_t duration;  // seconds
+    };
+
+    static const int kMaxEntries = 8;
+    static const uint32_t kNever = 0xFFFFFFFF;
+
+    Schedule();
+
+    // Decode an entry, return the slot or -1 if the encoding is invalid
+    static int Parse(const uint8_t* data, int len, Entry* entry);
+
+    void Set(int slot, const Entry& entry, uint32_t now);
+    const Entry& Get(int slot) const;
+    // Recompute every next firing time (e.g. when the clock is set)
+    void Rebase(uint32_t now);
+
+    uint32_t Next() const;  // earliest firing time, or kNever
+    // Return the slot of an entry due at `now` (or -1) and compute its
+    // next firing time.
+    int PopDue(uint32_t now);
+
+   private:
+    static uint32_t NextFiring(const Entry& entry, uint32_t now);
+
+    Entry entries_[kMaxEntries];
+    uint32_t next_[kMaxEntries];
+};
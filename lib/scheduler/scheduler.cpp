@@ -0,0 +1,128 @@
+/**
+ ******************************************************************************
+ * @file        : scheduler.cpp
+ * @brief       : Deadline scheduler
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Deadline scheduler
+ ******************************************************************************
+ */
+
+#include "scheduler.hpp"
+
+Scheduler::Scheduler() : size_(0) {
+    for (int i = 0; i < kMaxTimers; i++) {
+        pos_[i]      = -1;
+        deadline_[i] = kNever;
+    }
+}
+
+// Deadlines are compared modulo 2^32 so that the RTC epoch may wrap.
+bool Scheduler::Before(uint32_t a, uint32_t b) {
+    return static_cast<int32_t>(a - b) < 0;
+}
+
+void Scheduler::At(int id, uint32_t deadline) {
+    if (id < 0 || id >= kMaxTimers) {
+        return;
+    }
+    deadline_[id] = deadline;
+    int i         = pos_[id];
+    if (i < 0) {
+        i        = size_++;
+        heap_[i] = id;
+        pos_[id] = i;
+        SiftUp(i);
+        return;
+    }
+    SiftUp(i);
+    SiftDown(pos_[id]);
+}
+
+void Scheduler::Cancel(int id) {
+    if (!IsPending(id)) {
+        return;
+    }
+    RemoveAt(pos_[id]);
+}
+
+bool Scheduler::IsPending(int id) const {
+    return id >= 0 && id < kMaxTimers && pos_[id] >= 0;
+}
+
+uint32_t Scheduler::Deadline(int id) const {
+    return IsPending(id) ? deadline_[id] : kNever;
+}
+
+uint32_t Scheduler::Next() const {
+    return size_ == 0 ? kNever : deadline_[heap_[0]];
+}
+
+int Scheduler::PopExpired(uint32_t now) {
+    if (size_ == 0 || Before(now, deadline_[heap_[0]])) {
+        return kNoTimer;
+    }
+    int id = heap_[0];
+    RemoveAt(0);
+    return id;
+}
+
+void Scheduler::Swap(int i, int j) {
+    int t          = heap_[i];
+    heap_[i]       = heap_[j];
+    heap_[j]       = t;
+    pos_[heap_[i]] = i;
+    pos_[heap_[j]] = j;
+}
+
+void Scheduler::SiftUp(int i) {
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!Before(deadline_[heap_[i]], deadline_[heap_[parent]])) {
+            break;
+        }
+        Swap(i, parent);
+        i = parent;
+    }
+}
+
+void Scheduler::SiftDown(int i) {
+    for (;;) {
+        int smallest = i;
+        int left     = 2 * i + 1;
+        int right    = left + 1;
+        if (left < size_ &&
+            Before(deadline_[heap_[left]], deadline_[heap_[smallest]])) {
+            smallest = left;
+        }
+        if (right < size_ &&
+            Before(deadline_[heap_[right]], deadline_[heap_[smallest]])) {
+            smallest = right;
+        }
+        if (smallest == i) {
+            break;
+        }
+        Swap(i, smallest);
+        i = smallest;
+    }
+}
+
+void Scheduler::RemoveAt(int i) {
+    int id = heap_[i];
+    size_--;
+    if (i != size_) {
+        int moved = heap_[size_];
+        Swap(i, size_);
+        SiftUp(i);
+        SiftDown(pos_[moved]);
+    }
+    pos_[id]      = -1;
+    deadline_[id] = kNever;
+}
@@ -0,0 +1,61 @@
+/**
+ ******************************************************************************
+ * @file        : scheduler.hpp
+ * @brief       : Deadline scheduler
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Deadline scheduler. Every pending deadline (valve close, next uplink,
+ * transmission timeout, ...) is identified by a small integer (the timer id)
+ * and kept in a binary min-heap, so the main loop can sleep until the
+ * earliest one instead of polling.
+ *
+ * There is room for one timer per valve of the largest bank (32, the width
+ * of the valve masks) and for kNamedTimers more (uplink, timeouts, ...).
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+class Scheduler {
+   public:
+    static const int kValveTimers = 32;
+    static const int kNamedTimers = 8;
+    static const int kMaxTimers   = kValveTimers + kNamedTimers;
+    static const uint32_t kNever  = 0xFFFFFFFF;
+    static const int kNoTimer     = -1;
+
+    Scheduler();
+
+    // Arm (or re-arm) timer `id` to expire at `deadline` (RTC epoch).
+    void At(int id, uint32_t deadline);
+    void Cancel(int id);
+    bool IsPending(int id) const;
+    uint32_t Deadline(int id) const;
+
+    // Earliest deadline, or kNever if no timer is pending.
+    uint32_t Next() const;
+
+    // Remove and return the id of one expired timer, or kNoTimer.
+    int PopExpired(uint32_t now);
+
+   private:
+    static bool Before(uint32_t a, uint32_t b);
+    void Swap(int i, int j);
+    void SiftUp(int i);
+    void SiftDown(int i);
+    void RemoveAt(int i);
+
+    int size_;
+    int heap_[kMaxTimers];  // heap of timer ids
+    int pos_[kMaxTimers];   // position of each id in heap_, or -1
+    uint32_t deadline_[kMaxTimers];
+};
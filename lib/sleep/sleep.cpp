@@ -0,0 +1,110 @@
+/**
+ ******************************************************************************
+ * @file        : sleep.cpp
+ * @brief       : Deep sleep that keeps the LMIC time base
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Deep sleep that keeps the LMIC time base
+ ******************************************************************************
+ */
+
+#include "sleep.hpp"
+
+#include <ArduinoLowPower.h>
+#include <lmic.h>
+
+#include "profiler.hpp"
+
+// Provided by the linker (--wrap): the functions of the core
+extern "C" unsigned long __real_micros();  // NOLINT
+extern "C" unsigned long __real_millis();  // NOLINT
+
+extern "C" unsigned long __wrap_micros() { return Sleep.Micros(); }  // NOLINT
+extern "C" unsigned long __wrap_millis() { return Sleep.Millis(); }  // NOLINT
+
+DeepSleep Sleep;  // NOLINT
+
+DeepSleep::DeepSleep()
+    : rtc_(nullptr),
+      slept_(0),
+      offsetUs_(0),
+      offsetMs_(0),
+      anchored_(false),
+      anchorMicros_(0),
+      anchorSeconds_(0) {}
+
+void DeepSleep::Begin(RTCZero* rtc) { rtc_ = rtc; }
+
+uint32_t DeepSleep::Limit(uint32_t seconds) {
+    // One more second, as the alarm may ring up to a second late
+    while (seconds > 0 && os_queryTimeCriticalJobs(sec2osticks(seconds + 1))) {
+        seconds /= 2;
+    }
+    return seconds;
+}
+
+uint32_t DeepSleep::For(uint32_t seconds) {
+    os_radio(RADIO_RST);  // SX1276 in sleep mode
+
+    uint32_t start  = rtc_->getY2kEpoch();
+    uint32_t before = __real_micros();
+    // Time elapsed since the start of the current RTC second
+    uint32_t phase = kUsPerSecond - 1;
+    if (anchored_ && start - anchorSeconds_ < kMaxAnchorAge) {
+        phase = (before - anchorMicros_) % kUsPerSecond;
+    }
+
+#if LOW_POWER
+    LowPower.deepSleep(seconds * 1000);  // NOLINT
+    SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;  // or the next WFI is a standby
+#else
+    delay(seconds * 1000);  // NOLINT
+#endif
+
+    uint32_t after   = __real_micros();
+    uint32_t end     = rtc_->getY2kEpoch();
+    uint32_t counted = after - before;  // by the SysTick
+    int64_t measured =
+        static_cast<int64_t>(end - start) * kUsPerSecond - phase;
+    if (measured > counted) {
+        Advance(measured - counted);
+    }
+
+    // Woken by the alarm, on a second boundary
+    anchored_      = LOW_POWER && end - start >= seconds;
+    anchorMicros_  = after;
+    anchorSeconds_ = end;
+    return measured > counted ? measured : counted;
+}
+
+void DeepSleep::Idle() {
+    // The SysTick wakes the MCU every millisecond: a job due sooner than
+    // that would start late
+    if (os_queryTimeCriticalJobs(ms2osticks(1))) {
+        return;
+    }
+    Profile.Stop(Profiler::kAwake);
+    Profile.Start(Profiler::kIdle);
+    LowPower.idle();
+    Profile.Stop(Profiler::kIdle);
+    Profile.Start(Profiler::kAwake);
+}
+
+void DeepSleep::Advance(uint64_t us) {
+    slept_ += us;
+    noInterrupts();
+    offsetUs_ = slept_;
+    offsetMs_ = slept_ / 1000;  // NOLINT
+    interrupts();
+}
+
+uint32_t DeepSleep::Micros() const { return __real_micros() + offsetUs_; }
+
+uint32_t DeepSleep::Millis() const { return __real_millis() + offsetMs_; }
@@ -0,0 +1,88 @@
+/**
+ ******************************************************************************
+ * @file        : sleep.hpp
+ * @brief       : Deep sleep that keeps the LMIC time base
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Deep sleep (standby) with the radio in sleep mode, woken by the RTC alarm.
+ *
+ * In standby, the SysTick stops, and with it millis() and micros(), on which
+ * LMIC builds os_getTime(): its duty cycle and job times would fall behind.
+ * The firmware is linked with --wrap=micros and --wrap=millis, so that every
+ * caller but the core itself sees the SysTick time plus the time slept, as
+ * measured by the RTC.
+ *
+ * The RTC counts whole seconds, and the alarm wakes the MCU on a second
+ * boundary: the time slept is known to the microsecond once the phase of the
+ * SysTick with respect to the RTC seconds is known, that is after the first
+ * wake-up by the alarm. Until then, and whenever the measure is uncertain,
+ * the time slept is underestimated, so that the corrected time never runs
+ * ahead of the real time (LMIC would break the duty cycle) and never goes
+ * back.
+ *
+ * While LMIC waits for the radio (end of transmission, receive windows), the
+ * MCU idles instead: the SysTick keeps running, and its interrupt, a radio
+ * DIO interrupt (LMIC_USE_INTERRUPTS) or the pulse engine timer wake it up
+ * within a millisecond.
+ *
+ * LowPower.deepSleep() leaves SLEEPDEEP set in SCB->SCR. For() clears it on
+ * wake-up: otherwise the next bare WFI, such as the wait of a battery reading
+ * for its DMA, would enter standby, where the ADC clock stops and the reading
+ * never ends.
+ *
+ * Build with -D LOW_POWER=0 to keep the USB serial port alive: the MCU then
+ * waits with delay() instead of entering standby.
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <RTCZero.h>
+
+#ifndef LOW_POWER
+#define LOW_POWER 1
+#endif
+
+class DeepSleep {
+   public:
+    static const uint32_t kUsPerSecond = 1000000;
+    // Longest time awake over which the SysTick phase is trusted, well
+    // below the wrap of micros() (71 minutes)
+    static const uint32_t kMaxAnchorAge = 30 * 60;
+
+    DeepSleep();
+    void Begin(RTCZero* rtc);
+
+    // Longest sleep, up to `seconds`, that ends before the next LMIC job
+    // (0 if one is due within a second)
+    static uint32_t Limit(uint32_t seconds);
+    // Put the radio and the MCU to sleep, return the time slept in us
+    uint32_t For(uint32_t seconds);
+    // Idle until the next interrupt, unless an LMIC job is due
+    static void Idle();
+
+    // SysTick time plus the time slept
+    uint32_t Micros() const;
+    uint32_t Millis() const;
+
+   private:
+    void Advance(uint64_t us);
+
+    RTCZero* rtc_;
+    uint64_t slept_;               // us, total
+    volatile uint32_t offsetUs_;   // slept_, for micros()
+    volatile uint32_t offsetMs_;   // slept_, for millis()
+    bool anchored_;                // the SysTick phase is known
+    uint32_t anchorMicros_;        // SysTick at an RTC second boundary
+    uint32_t anchorSeconds_;       // RTC at the same time
+};
+
+extern DeepSleep Sleep;  // NOLINT
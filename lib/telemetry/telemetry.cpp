@@ -0,0 +1,67 @@
+/**
+ ******************************************************************************
+ * @file        : telemetry.cpp
+ * @brief       : Telemetry buffer
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Telemetry buffer
+ ******************************************************************************
+ */
+
+#include "telemetry.hpp"
+
+Telemetry::Telemetry(int nOfValves)
+    : nOfValves_(nOfValves), head_(0), count_(0), pending_(0), lost_(0) {}
+
+void Telemetry::Push(const Record& record) {
+    if (count_ == kCapacity) {
+        head_ = (head_ + 1) % kCapacity;
+        count_--;
+        if (pending_ > 0) {
+            pending_--;
+        }
+        lost_++;
+    }
+    records_[(head_ + count_) % kCapacity] = record;
+    count_++;
+}
+
+void Telemetry::AddSample(uint32_t time, uint16_t millivolts, uint32_t valves) {
+    Push({time, valves, millivolts, kSample, 0});
+}
+
+void Telemetry::AddEvent(uint32_t time, Kind kind, int valve) {
+    Push({time, 0, 0, static_cast<uint8_t>(kind), static_cast<uint8_t>(valve)});
+}
+
+int Telemetry::Size() const { return count_; }
+
+const Telemetry::Record& Telemetry::At(int i) const {
+    return records_[(head_ + i) % kCapacity];
+}
+
+int Telemetry::Encode(uint32_t now, uint8_t* buffer, int size) {
+    TelemetryWriter writer(buffer, size, now, nOfValves_);
+    int n = 0;
+    while (n < count_ && writer.Add(At(n))) {
+        n++;
+    }
+    pending_ = n;
+    return writer.Finish(lost_);
+}
+
+void Telemetry::Commit() {
+    head_  = (head_ + pending_) % kCapacity;
+    count_ = count_ - pending_;
+    if (pending_ > 0) {
+        lost_ = 0;
+    }
+    pending_ = 0;
+}
@@ -0,0 +1,55 @@
+/**
+ ******************************************************************************
+ * @file        : telemetry.hpp
+ * @brief       : Telemetry buffer
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Telemetry buffer. Samples (battery voltage and valve status) and valve
+ * events are kept in a ring buffer (the oldest records are dropped when it
+ * is full) and sent in batches, as many as fit in one uplink. The frame
+ * format is described in the codec library.
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+#include "codec.hpp"
+
+class Telemetry : public TelemetryFormat {
+   public:
+    static const int kCapacity = 64;
+
+    explicit Telemetry(int nOfValves);
+
+    void AddSample(uint32_t time, uint16_t millivolts, uint32_t valves);
+    void AddEvent(uint32_t time, Kind kind, int valve);
+    int Size() const;
+
+    // Encode as many records as fit in `size` bytes, oldest first, and
+    // return the length of the frame (0 if there is nothing to send).
+    int Encode(uint32_t now, uint8_t* buffer, int size);
+    // Drop the records carried by the last encoded frame.
+    void Commit();
+
+   private:
+    using Record = TelemetryRecord;
+
+    void Push(const Record& record);
+    const Record& At(int i) const;  // i-th oldest record
+
+    int nOfValves_;
+    Record records_[kCapacity];
+    int head_;     // oldest record
+    int count_;
+    int pending_;  // records carried by the last encoded frame
+    int lost_;
+};
@@ -0,0 +1,95 @@
+/**
+ ******************************************************************************
+ * @file        : trace.cpp
+ * @brief       : Deferred binary trace
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Deferred binary trace
+ ******************************************************************************
+ */
+
+#include "trace.hpp"
+
+#include "codec.hpp"
+
+TraceBuffer Trace;  // NOLINT
+
+TraceBuffer::TraceBuffer()
+    : out_(nullptr), buffer_{}, head_(0), count_(0), last_(0), dropped_(0) {}
+
+void TraceBuffer::Begin(Print* out) {
+    out_  = out;
+    last_ = millis();
+}
+
+void TraceBuffer::Write(uint8_t id, const int32_t* args, int n) {
+    uint8_t record[kMaxRecord];
+    uint32_t now = millis();
+    int len      = 3;
+    len += Varint::Put(record + len, kMaxRecord - len, now - last_);
+    for (int i = 0; i < n; i++) {
+        uint32_t zigzag = (static_cast<uint32_t>(args[i]) << 1) ^
+                          static_cast<uint32_t>(args[i] >> 31);  // NOLINT
+        len += Varint::Put(record + len, kMaxRecord - len, zigzag);
+    }
+    record[0] = kSync;
+    record[1] = id;
+    record[2] = len - 3;
+
+    if (dropped_ > 0) {
+        uint8_t lost[3 + 2 * Varint::kMaxSize32];
+        int lostLen = 3;
+        lostLen += Varint::Put(lost + lostLen, sizeof(lost) - lostLen, 0U);
+        lostLen +=
+            Varint::Put(lost + lostLen, sizeof(lost) - lostLen, dropped_ << 1);
+        lost[0] = kSync;
+        lost[1] = static_cast<uint8_t>(TraceEvent::TraceDropped);
+        lost[2] = lostLen - 3;
+        if (count_ + lostLen + len > kSize || !Push(lost, lostLen)) {
+            dropped_++;
+            return;
+        }
+        dropped_ = 0;
+    }
+    if (!Push(record, len)) {
+        dropped_++;
+        return;
+    }
+    last_ = now;
+}
+
+bool TraceBuffer::Push(const uint8_t* record, int len) {
+    if (count_ + len > kSize) {
+        return false;
+    }
+    for (int i = 0; i < len; i++) {
+        buffer_[(head_ + count_ + i) % kSize] = record[i];
+    }
+    count_ += len;
+    return true;
+}
+
+void TraceBuffer::Drain() {
+    if (out_ == nullptr) {
+        return;
+    }
+    while (count_ > 0) {
+        int room = out_->availableForWrite();
+        if (room <= 0) {
+            return;
+        }
+        int n = min(min(count_, kSize - head_), room);
+        out_->write(buffer_ + head_, n);
+        head_ = (head_ + n) % kSize;
+        count_ -= n;
+    }
+}
+
+bool TraceBuffer::Empty() const { return count_ == 0; }
@@ -0,0 +1,110 @@
+/**
+ ******************************************************************************
+ * @file        : trace.hpp
+ * @brief       : Deferred binary trace
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Deferred binary trace. TRACE(Event, args...) stores a compact record in a
+ * RAM ring buffer, and Drain() writes the buffer to the serial port, only as
+ * much as it accepts without blocking. Events above TRACE_LEVEL (a build
+ * flag, TRACE_LEVEL_INFO by default) are compiled out, arguments included.
+ * The records are decoded on the host by tools/trace_decode.py.
+ *
+ * Record: sync byte (0xA5), event id, payload length, then the payload: the
+ * time since the previous record in ms and the arguments (zigzag encoded),
+ * as LEB128 varints. When the buffer is full, records are dropped and
+ * counted (TraceDropped event).
+ *
+ * TRACE must not be used from interrupt handlers.
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+#include "trace_events.hpp"
+
+#define TRACE_LEVEL_NONE 0
+#define TRACE_LEVEL_ERROR 1
+#define TRACE_LEVEL_WARNING 2
+#define TRACE_LEVEL_INFO 3
+#define TRACE_LEVEL_TRACE 4
+
+#ifndef TRACE_LEVEL
+#define TRACE_LEVEL TRACE_LEVEL_INFO
+#endif
+
+enum TraceLevel : uint8_t {
+    kError   = TRACE_LEVEL_ERROR,
+    kWarning = TRACE_LEVEL_WARNING,
+    kInfo    = TRACE_LEVEL_INFO,
+    kTrace   = TRACE_LEVEL_TRACE
+};
+
+enum class TraceEvent : uint8_t {
+#define TRACE_EVENT_ID(name, level, format) name,
+    TRACE_EVENTS(TRACE_EVENT_ID)
+#undef TRACE_EVENT_ID
+};
+
+constexpr TraceLevel kTraceLevels[] = {
+#define TRACE_EVENT_LEVEL(name, level, format) level,
+    TRACE_EVENTS(TRACE_EVENT_LEVEL)
+#undef TRACE_EVENT_LEVEL
+};
+
+constexpr bool TraceEnabled(TraceEvent event) {
+    return kTraceLevels[static_cast<int>(event)] <= TRACE_LEVEL;
+}
+
+// NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
+#define TRACE(event, ...)                                      \
+    do {                                                       \
+        if constexpr (TraceEnabled(TraceEvent::event)) {       \
+            Trace.Record(TraceEvent::event, ##__VA_ARGS__);    \
+        }                                                      \
+    } while (0)
+
+class TraceBuffer {
+   public:
+    static const int kSize      = 512;
+    static const int kMaxArgs   = 8;
+    static const uint8_t kSync  = 0xA5;
+    static const int kMaxRecord = 3 + 5 * (kMaxArgs + 1);
+
+    TraceBuffer();
+    void Begin(Print* out);
+
+    template <typename... Args>
+    void Record(TraceEvent event, Args... args) {
+        static_assert(sizeof...(Args) <= kMaxArgs, "too many arguments");
+        const int32_t values[sizeof...(Args) + 1] = {
+            static_cast<int32_t>(args)...};
+        Write(static_cast<uint8_t>(event), values, sizeof...(Args));
+    }
+
+    // Write as much as the serial port accepts without blocking
+    void Drain();
+    bool Empty() const;
+
+   private:
+    void Write(uint8_t id, const int32_t* args, int n);
+    bool Push(const uint8_t* record, int len);
+
+    Print* out_;
+    uint8_t buffer_[kSize];
+    int head_;
+    int count_;
+    uint32_t last_;  // time of the previous record, ms
+    uint32_t dropped_;
+};
+
+extern TraceBuffer Trace;  // NOLINT
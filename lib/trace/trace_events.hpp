@@ -0,0 +1,84 @@
+/**
+ ******************************************************************************
+ * @file        : trace_events.hpp
+ * @brief       : Trace events
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Trace events: X(name, level, format). The id of an event is its position
+ * in the table, so new events go at the end. The formats are only used by
+ * the host decoder (tools/trace_decode.py), which reads this file: they
+ * take no space on the device. Format specifiers are %d, %u, %x (with an
+ * optional width, e.g. %08x) and %{Enum}, which prints the name of an
+ * enumerator of the enum `Enum` declared in lib/ (ev_t for LMIC events).
+ ******************************************************************************
+ */
+
+#pragma once
+
+// clang-format off
+#define TRACE_EVENTS(X)                                                        \
+    X(TraceDropped, kWarning, "%u trace records dropped")                      \
+    X(Starting, kInfo, "Starting")                                             \
+    X(ResetByWatchdog, kWarning, "Reset by the watchdog")                      \
+    X(Status, kInfo, "Loop : @%u, open valves %x")                             \
+    X(ClosingOthers, kInfo, "Closing all other valves")                        \
+    X(InvalidConfiguration, kWarning, "Invalid configuration payload")         \
+    X(HeartbeatSet, kInfo, "Heartbeat set to %u seconds")                      \
+    X(HysteresisSet, kInfo, "Voltage hysteresis set to %dmV")                  \
+    X(ClockSet, kInfo, "Clock set, offset %d seconds")                         \
+    X(InvalidSchedule, kWarning, "Invalid schedule entry")                     \
+    X(ScheduleSet, kInfo,                                                      \
+      "Schedule %d: valve %d, days %x, at %d min for %u s")                    \
+    X(ScheduleFired, kInfo, "Schedule %d fired")                               \
+    X(InvalidValve, kWarning, "Invalid valve %d")                              \
+    X(UnsupportedCommand, kWarning, "Unsupported command %x")                  \
+    X(MalformedPayload, kWarning, "Malformed payload (%d bytes), ignored")     \
+    X(ValidPayload, kInfo, "Received valid payload")                           \
+    X(SaveFailed, kError, "Saving the state failed")                           \
+    X(StateSaved, kInfo, "State saved")                                        \
+    X(NoSavedState, kInfo, "No saved state")                                   \
+    X(SessionRestored, kInfo, "Session restored, FCntUp %u")                   \
+    X(StateRestored, kInfo, "State restored")                                  \
+    X(TooManyFollowUps, kWarning,                                              \
+      "Too many follow-up uplinks, waiting for the heartbeat")                 \
+    X(FollowUp, kInfo, "Follow-up uplink (downlink pending: %d)")              \
+    X(LinkDecision, kInfo,                                                     \
+      "Link %{Decision}: DR%d, %ddBm (margin %ddB, RSSI %ddBm)")               \
+    X(TxPending, kWarning, "OP_TXRXPEND, not sending")                         \
+    X(BatteryVoltage, kInfo, "Battery voltage: %dmV")                          \
+    X(Queuing, kInfo, "Queuing packet, %d bytes for %d records")               \
+    X(SendingUplink, kInfo, "Sending uplink (%{Reason})")                      \
+    X(NothingToSend, kWarning, "Nothing fits, no uplink on port %d")           \
+    X(TxTimeout, kError,                                                       \
+      "Transmission timeout, recovery: %{Stage} (%d so far)")                  \
+    X(NextAttempt, kInfo, "Next attempt in %u seconds")                        \
+    X(ValveAlreadyOpen, kWarning, "Valve %d is already open")                  \
+    X(ValveOpening, kInfo, "Opening valve %d")                                 \
+    X(ValveAlreadyClosed, kWarning, "Valve %d is already closed")              \
+    X(ValveClosing, kInfo, "Closing valve %d")                                 \
+    X(PulseWidth, kInfo, "Supply %umV, pulse width %ums")                      \
+    X(PulseQueueFull, kError, "Pulse queue full, valve %d not actuated")       \
+    X(ValveCloseScheduled, kInfo,                                              \
+      "Scheduling valve %d to close in %d seconds")                            \
+    X(LmicEvent, kTrace, "%{ev_t}")                                            \
+    X(Session, kTrace, "netid: %u, devaddr: %08x")                             \
+    X(AppSKey, kTrace, "AppSKey: %08x%08x%08x%08x")                            \
+    X(NwkSKey, kTrace, "NwkSKey: %08x%08x%08x%08x")                            \
+    X(ReceivedAck, kTrace, "Received ack")                                     \
+    X(ReceivedPayload, kTrace, "Received %d bytes of payload")                 \
+    X(SendingDiagnostics, kInfo, "Sending diagnostics, %d bytes")              \
+    X(DuplicateDownlink, kInfo, "Duplicate downlink %u, ignored")              \
+    X(CommandQueueFull, kWarning, "Command queue full, command %x dropped")    \
+    X(SendingValveStats, kInfo, "Sending valve statistics, %d bytes")          \
+    X(AppendingValveStats, kInfo, "Valve statistics of %x appended, %d bytes") \
+    X(ClassBRequested, kInfo, "Class B periodicity %d requested (255: off)")   \
+    X(ClassBAction, kInfo, "Class B %{Action}: periodicity %d at %dmV")        \
+    X(ClassBFallback, kWarning, "Class A, next beacon scan at %u")
+// clang-format on
@@ -0,0 +1,127 @@
+/**
+ ******************************************************************************
+ * @file        : uplink.cpp
+ * @brief       : Uplink policy
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Uplink policy
+ ******************************************************************************
+ */
+
+#include "uplink.hpp"
+
+UplinkPolicy::UplinkPolicy(uint32_t heartbeat, uint16_t hysteresis)
+    : heartbeat_(heartbeat),
+      hysteresis_(hysteresis),
+      sent_(false),
+      requested_(false),
+      followUp_(false),
+      followUps_(0),
+      offTime_(0),
+      notBefore_(0),
+      lastSent_(0),
+      lastValves_(0),
+      lastMillivolts_(0) {}
+
+UplinkPolicy::Reason UplinkPolicy::Check(uint32_t now,
+                                         uint32_t valves,
+                                         uint16_t millivolts) const {
+    if (!sent_) {
+        return kFirst;
+    }
+    if (requested_) {
+        return kRequested;
+    }
+    if (followUp_) {
+        return kFollowUp;
+    }
+    if (valves != lastValves_) {
+        return kValves;
+    }
+    int delta = static_cast<int>(millivolts) - lastMillivolts_;
+    if (abs(delta) > hysteresis_) {
+        return kVoltage;
+    }
+    if (now - lastSent_ >= heartbeat_) {
+        return kHeartbeat;
+    }
+    return kNone;
+}
+
+void UplinkPolicy::Sent(uint32_t now, uint32_t valves, uint16_t millivolts) {
+    if (!followUp_) {
+        followUps_ = 0;  // end of the chain
+    }
+    sent_           = true;
+    requested_      = false;
+    followUp_       = false;
+    lastSent_       = now;
+    lastValves_     = valves;
+    lastMillivolts_ = millivolts;
+}
+
+void UplinkPolicy::Request() { requested_ = true; }
+
+bool UplinkPolicy::FollowUp() {
+    if (followUps_ >= kMaxFollowUps) {
+        return false;
+    }
+    followUps_++;
+    followUp_ = true;
+    return true;
+}
+
+void UplinkPolicy::SetAirTime(uint32_t ms) {
+    offTime_ = (ms * (kDutyCycle - 1) + 999) / 1000;  // NOLINT
+}
+
+void UplinkPolicy::Backoff(uint32_t time) { notBefore_ = time; }
+
+uint32_t UplinkPolicy::Earliest() const {
+    uint32_t spacing  = max(kMinUplinkSpacing, offTime_);
+    uint32_t earliest = sent_ ? lastSent_ + spacing : 0;
+    if (static_cast<int32_t>(notBefore_ - earliest) > 0) {
+        earliest = notBefore_;
+    }
+    return earliest;
+}
+
+uint32_t UplinkPolicy::NextHeartbeat() const { return lastSent_ + heartbeat_; }
+
+void UplinkPolicy::SetHeartbeat(uint32_t seconds) {
+    if (seconds == 0) {
+        seconds = kDefaultHeartbeat;
+    }
+    heartbeat_ = max(seconds, kMinHeartbeat);
+}
+
+uint32_t UplinkPolicy::Heartbeat() const { return heartbeat_; }
+
+void UplinkPolicy::SetHysteresis(uint16_t millivolts) {
+    hysteresis_ = millivolts;
+}
+
+uint16_t UplinkPolicy::Hysteresis() const { return hysteresis_; }
+
+// Semtech AN1200.13, with the low data rate optimization for SF11 and SF12
+uint32_t AirTime(int spreadingFactor, int len) {
+    const int kPreamble   = 8;
+    const int kCodingRate = 1;  // 4/5
+    int sf                = spreadingFactor;
+    int de                = sf >= 11 ? 1 : 0;  // NOLINT
+    uint32_t symbol       = (1UL << sf) * 8;   // us at 125 kHz - NOLINT
+    int num               = 8 * len - 4 * sf + 28 + 16;  // NOLINT
+    int den               = 4 * (sf - 2 * de);
+    int n                 = num > 0 ? (num + den - 1) / den : 0;
+    uint32_t symbols      = 8 + n * (kCodingRate + 4);  // NOLINT
+    // The preamble has 4.25 more symbols than programmed
+    uint32_t us = symbol * (kPreamble * 4 + 17) / 4 + symbol * symbols;
+    return (us + 999) / 1000;  // NOLINT
+}
@@ -0,0 +1,92 @@
+/**
+ ******************************************************************************
+ * @file        : uplink.hpp
+ * @brief       : Uplink policy
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Uplink policy. An uplink is sent as soon as the valve status changes or
+ * the battery voltage moves by more than the hysteresis since the last
+ * report. Otherwise, a heartbeat is sent every `heartbeat` seconds. Two
+ * uplinks are always at least kMinUplinkSpacing seconds apart. An uplink
+ * can also be requested explicitly (e.g. by a query downlink).
+ *
+ * A follow-up uplink is sent as soon as the duty cycle allows when the last
+ * downlink carried commands (its sample acknowledges them) or when the
+ * network has more downlinks queued (FPending), so that they are pulled
+ * without waiting for the next heartbeat. At most kMaxFollowUps follow-ups
+ * are chained.
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+const uint32_t kDefaultHeartbeat  = 60 * 60;  // 1 hour
+const uint32_t kMinHeartbeat      = 5 * 60;   // 5 minutes
+const uint16_t kDefaultHysteresis = 100;      // mV
+const uint32_t kMinUplinkSpacing  = 10;       // seconds
+const int kMaxFollowUps           = 8;
+const uint32_t kDutyCycle         = 100;  // 1 %, as a divisor
+
+// Time on air in ms of a LoRa frame of `len` bytes (PHY payload), 125 kHz,
+// coding rate 4/5, explicit header and CRC.
+uint32_t AirTime(int spreadingFactor, int len);
+
+class UplinkPolicy {
+   public:
+    enum Reason {
+        kNone,
+        kFirst,
+        kRequested,
+        kFollowUp,
+        kValves,
+        kVoltage,
+        kHeartbeat
+    };
+
+    explicit UplinkPolicy(uint32_t heartbeat  = kDefaultHeartbeat,
+                          uint16_t hysteresis = kDefaultHysteresis);
+
+    // Why an uplink is due for the given state, or kNone.
+    Reason Check(uint32_t now, uint32_t valves, uint16_t millivolts) const;
+    // Record the state that has just been reported.
+    void Sent(uint32_t now, uint32_t valves, uint16_t millivolts);
+
+    void Request();
+    // Return false if too many follow-ups have already been chained
+    bool FollowUp();
+    // Time on air of the last uplink, in ms, for the duty cycle
+    void SetAirTime(uint32_t ms);
+    // No uplink before `time` (e.g. after a failed transmission)
+    void Backoff(uint32_t time);
+
+    // Earliest time at which an uplink may be sent.
+    uint32_t Earliest() const;
+    uint32_t NextHeartbeat() const;
+
+    void SetHeartbeat(uint32_t seconds);
+    uint32_t Heartbeat() const;
+    void SetHysteresis(uint16_t millivolts);
+    uint16_t Hysteresis() const;
+
+   private:
+    uint32_t heartbeat_;   // s
+    uint16_t hysteresis_;  // mV
+    bool sent_;
+    bool requested_;
+    bool followUp_;
+    int followUps_;     // chained follow-ups
+    uint32_t offTime_;  // s, after the last uplink
+    uint32_t notBefore_;
+    uint32_t lastSent_;
+    uint32_t lastValves_;
+    uint16_t lastMillivolts_;
+};
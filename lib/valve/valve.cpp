@@ -18,62 +18,157 @@
 #include "valve.hpp"
 
 #include <Arduino.h>
-#include <ArduinoLog.h>
 #include <RTCZero.h>
 
+#include "profiler.hpp"
+#include "trace.hpp"
+
 // NOLINTNEXTLINE
-Valve::Valve(int id, RTCZero* rtc, int pinOn, int pinOff, int pulseWidth)
+Valve::Valve(int id,
+             RTCZero* rtc,
+             Scheduler* scheduler,
+             Battery* battery,
+             int lineOn,
+             int lineOff,
+             PortPin sensePin,
+             int pulseWidth)
     : id_(id),
       rtc_(rtc),
-      pinOn_(pinOn),
-      pinOff_(pinOff),
+      scheduler_(scheduler),
+      battery_(battery),
+      lineOn_(lineOn),
+      lineOff_(lineOff),
+      sensePin_(sensePin),
       pulseWidth_(pulseWidth),
-      isOpen_(false) {
-    pinMode(pinOn_, OUTPUT);
-    pinMode(pinOff_, OUTPUT);
-    t0_    = 0;
-    delay_ = 0;
+      state_(kClosed),
+      openedAt_(0),
+      openSeconds_(0),
+      lastChange_(0),
+      actuations_(0),
+      failedCloses_(0),
+      forcedCloses_(0) {}
+
+void Valve::Begin() {
+    if (sensePin_.IsValid()) {
+        ConfigureInput(sensePin_);
+    }
 }
 
-void Valve::Open() {
-    if (isOpen_) {
-        Log.warningln("Valve %i is already open", id_);
-        return;
+bool Valve::Open() {
+    if (IsOpen()) {
+        TRACE(ValveAlreadyOpen, id_);
+        return false;
+    }
+    TRACE(ValveOpening, id_);
+    if (!Pulse(lineOn_, kOpening, OnOpened)) {
+        return false;
     }
-    Log.infoln("Opening valve %i", id_);
-    digitalWrite(pinOn_, HIGH);
-    delay(pulseWidth_);
-    digitalWrite(pinOn_, LOW);
-    isOpen_ = true;
+    openedAt_   = rtc_->getY2kEpoch();
+    lastChange_ = openedAt_;
+    actuations_++;
+    return true;
 }
 
-void Valve::Close(bool force) {
-    if (!isOpen_ && !force) {
-        Log.warningln("Valve %i is already closed", id_);
-        return;
+bool Valve::Close(bool force) {
+    scheduler_->Cancel(id_);
+    bool open = IsOpen();
+    if (!open && !force) {
+        TRACE(ValveAlreadyClosed, id_);
+        return false;
     }
-    Log.infoln("Closing valve %i", id_);
-    digitalWrite(pinOff_, HIGH);
-    delay(pulseWidth_);
-    digitalWrite(pinOff_, LOW);
-    isOpen_ = false;
+    TRACE(ValveClosing, id_);
+    uint32_t now = rtc_->getY2kEpoch();
+    lastChange_  = now;
+    if (!Pulse(lineOff_, kClosing, OnClosed)) {
+        noInterrupts();
+        failedCloses_ = failedCloses_ + 1;
+        interrupts();
+        return false;
+    }
+    actuations_++;
+    if (open) {
+        openSeconds_ += now - openedAt_;
+    } else {
+        forcedCloses_++;
+    }
+    return true;
 }
 
-void Valve::ScheduleClose(int seconds) {
-    t0_    = rtc_->getY2kEpoch();
-    delay_ = seconds;
-    Log.infoln("Scheduling valve %i to close in %i seconds", id_, seconds);
+// Width of the next pulse, from a fresh reading of the supply voltage
+uint16_t Valve::PulseWidth() {
+    uint32_t supply = battery_->Voltage();
+    if (supply == 0) {
+        return pulseWidth_;
+    }
+    uint32_t width = pulseWidth_ * kNominalSupply / supply;
+    width          = constrain(width, kMinPulseWidth, kMaxPulseWidth);
+    TRACE(PulseWidth, supply, width);
+    return width;
+}
+
+bool Valve::Pulse(int line, State transient, PulseEngine::Callback done) {
+    State previous = state_;
+    state_         = transient;
+    if (!Pulses.Start(
+            line, PulseWidth(), done, this, sensePin_, kMinPulseWidth)) {
+        TRACE(PulseQueueFull, id_);
+        state_ = previous;
+        return false;
+    }
+    return true;
 }
 
-bool Valve::IsOpen() const { return isOpen_; }
+// Pulse completion, called from the pulse engine interrupt. A newer command
+// may have been queued meanwhile, in which case the state is left alone.
+void Valve::OnOpened(void* context, uint16_t width, bool /* sensed */) {
+    auto* valve = static_cast<Valve*>(context);
+    Profile.Add(Profiler::kPulse, width * Profiler::kTicksPerMs);
+    if (valve->state_ == kOpening) {
+        valve->state_ = kOpen;
+    }
+}
 
-void Valve::LoopOnce() {
-    if (delay_ == 0) {
-        return;
+void Valve::OnClosed(void* context, uint16_t width, bool sensed) {
+    auto* valve = static_cast<Valve*>(context);
+    Profile.Add(Profiler::kPulse, width * Profiler::kTicksPerMs);
+    if (valve->state_ == kClosing) {
+        valve->state_ = kClosed;
     }
-    uint32_t t = rtc_->getY2kEpoch();  // NOLINT
-    if (t - t0_ >= delay_) {
-        Close();
-        delay_ = 0;
+    if (valve->sensePin_.IsValid() && !sensed) {
+        valve->failedCloses_ = valve->failedCloses_ + 1;
+    }
+}
+
+void Valve::ScheduleClose(int seconds) {
+    scheduler_->At(id_, rtc_->getY2kEpoch() + seconds);
+    TRACE(ValveCloseScheduled, id_, seconds);
+}
+
+void Valve::CancelClose() { scheduler_->Cancel(id_); }
+
+uint32_t Valve::CloseDeadline() const {
+    return scheduler_->IsPending(id_) ? scheduler_->Deadline(id_)
+                                      : Scheduler::kNever;
+}
+
+void Valve::Restore(bool open) {
+    state_    = open ? kOpen : kClosed;
+    openedAt_ = rtc_->getY2kEpoch();  // the time open before is lost
+}
+
+bool Valve::IsOpen() const {
+    return state_ == kOpening || state_ == kOpen;
+}
+
+ValveStats Valve::Stats() const {
+    ValveStats stats;
+    stats.openSeconds = openSeconds_;
+    if (IsOpen()) {
+        stats.openSeconds += rtc_->getY2kEpoch() - openedAt_;
     }
+    stats.lastChange   = lastChange_;
+    stats.actuations   = actuations_;
+    stats.failedCloses = failedCloses_;
+    stats.forcedCloses = forcedCloses_;
+    return stats;
 }
@@ -20,25 +20,70 @@
 #include <Arduino.h>
 #include <RTCZero.h>
 
-static const int kPulseWidth = 300; // 300 ms
+#include "battery.hpp"
+#include "codec.hpp"
+#include "gpio.hpp"
+#include "pulse.hpp"
+#include "scheduler.hpp"
+
+static const int kPulseWidth = 300; // 300 ms at kNominalSupply
+static const uint32_t kNominalSupply = 3700;  // mV
+static const int kMinPulseWidth      = 100;   // ms
+static const int kMaxPulseWidth      = 600;   // ms
+
+// The pulse width is scaled with the supply voltage (the latch needs a
+// given flux, that is a constant voltage x time product). If the valve has a
+// sense input, the pulse ends as soon as it reports that the latch flipped.
+//
+// Each valve also counts, since the reset, its open time, its coil pulses and
+// its failed and forced closes, in constant time per command.
 class Valve {
    public:
-    // NOLINTNEXTLINE
-    Valve(int id, RTCZero* rtc, int pinOn, int pinOff, int pulseWidth = kPulseWidth);
-    void Open();
-    void Close(bool force = false);
+    // The valve uses its id as timer id in the scheduler. The coils are
+    // lines of the pulse engine output (see ValveBank).
+    Valve(int id,
+          RTCZero* rtc,
+          Scheduler* scheduler,
+          Battery* battery,
+          int lineOn,
+          int lineOff,
+          PortPin sensePin = kNoPin,
+          int pulseWidth   = kPulseWidth);
+    void Begin();  // configure the sense input, if any
+    // Return true if a coil pulse has been queued
+    bool Open();
+    bool Close(bool force = false);
     void ScheduleClose(int seconds);
-    bool IsOpen() const;
-
-    void LoopOnce();
+    void CancelClose();
+    uint32_t CloseDeadline() const;  // RTC time, or Scheduler::kNever
+    // Restore the state saved before a reset, without pulsing the coil
+    void Restore(bool open);
+    bool IsOpen() const;       // open or opening
+    ValveStats Stats() const;  // open time counted up to now
 
    private:
+    // Opening and Closing while the coil pulse is running
+    enum State { kClosed, kOpening, kOpen, kClosing };
+
+    static void OnOpened(void* context, uint16_t width, bool sensed);
+    static void OnClosed(void* context, uint16_t width, bool sensed);
+    bool Pulse(int line, State transient, PulseEngine::Callback done);
+    uint16_t PulseWidth();
+
     int id_;
     RTCZero* rtc_;
-    int pinOn_;
-    int pinOff_;
+    Scheduler* scheduler_;
+    Battery* battery_;
+    int lineOn_;
+    int lineOff_;
+    PortPin sensePin_;
     int pulseWidth_;  // ms
-    bool isOpen_;
-    uint32_t t0_;
-    uint32_t delay_;
+    volatile State state_;
+    // Statistics, see ValveStats
+    uint32_t openedAt_;  // RTC time
+    uint32_t openSeconds_;
+    uint32_t lastChange_;
+    uint16_t actuations_;
+    volatile uint16_t failedCloses_;  // also counted by OnClosed()
+    uint16_t forcedCloses_;
 };
@@ -0,0 +1,99 @@
+/**
+ ******************************************************************************
+ * @file        : valve_bank.hpp
+ * @brief       : Bank of valves
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Bank of N valves, allocated statically. Valve i drives lines 2i (open) and
+ * 2i+1 (close) of the coil output, which is also the output of the pulse
+ * engine.
+ *
+ * Operations on several valves take a bitmask (bit i = valve i); the coils
+ * themselves are pulsed one after the other by the pulse engine, to limit
+ * the current drawn from the battery. All the coil lines are configured and
+ * released at once, with a single flush of the output.
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <RTCZero.h>
+
+#include <array>
+#include <utility>
+
+#include "output.hpp"
+#include "valve.hpp"
+
+template <int N>
+class ValveBank {
+   public:
+    static_assert(N > 0 && N <= 32, "valve masks are 32 bits");  // NOLINT
+
+    static const int kSize     = N;
+    static const uint32_t kAll = N == 32 ? 0xFFFFFFFF : (1UL << N) - 1;
+
+    ValveBank(CoilOutput* output,
+              RTCZero* rtc,
+              Scheduler* scheduler,
+              Battery* battery)
+        : ValveBank(output,
+                    rtc,
+                    scheduler,
+                    battery,
+                    std::make_index_sequence<N>()) {}
+
+    void Begin() {
+        output_->Clear();
+        output_->Begin();
+        output_->Flush();
+        for (Valve& valve : valves_) {
+            valve.Begin();
+        }
+    }
+
+    Valve& operator[](int i) { return valves_[i]; }
+    const Valve& operator[](int i) const { return valves_[i]; }
+
+    uint32_t OpenMask() const {  // open or opening
+        uint32_t mask = 0;
+        for (int i = 0; i < N; i++) {
+            if (valves_[i].IsOpen()) {
+                mask |= 1UL << i;
+            }
+        }
+        return mask;
+    }
+
+    // Return the mask of the valves actually actuated
+    uint32_t Close(uint32_t mask, bool force = false) {
+        uint32_t done = 0;
+        for (int i = 0; i < N; i++) {
+            if ((mask & (1UL << i)) != 0 && valves_[i].Close(force)) {
+                done |= 1UL << i;
+            }
+        }
+        return done;
+    }
+
+   private:
+    template <size_t... I>
+    ValveBank(CoilOutput* output,
+              RTCZero* rtc,
+              Scheduler* scheduler,
+              Battery* battery,
+              std::index_sequence<I...> /*unused*/)
+        : output_(output),
+          valves_{{Valve(I, rtc, scheduler, battery, 2 * I, 2 * I + 1)...}} {}
+
+    CoilOutput* output_;
+    std::array<Valve, N> valves_;
+};
@@ -0,0 +1,14 @@
+Import("env")
+
+# Map file of the linker and "pio run -t memory" to report the RAM and flash
+# used by each library against tools/memory_budget.txt.
+
+env.Append(LINKFLAGS=["-Wl,-Map,$BUILD_DIR/${PROGNAME}.map"])
+
+env.AddCustomTarget(
+    name="memory",
+    dependencies="$BUILD_DIR/${PROGNAME}.elf",
+    actions='"$PYTHONEXE" tools/memory_report.py '
+    '"$BUILD_DIR/${PROGNAME}.map" tools/memory_budget.txt',
+    title="Memory",
+    description="RAM and flash used by each library, against the budget")
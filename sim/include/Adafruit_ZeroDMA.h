@@ -0,0 +1,56 @@
+/**
+ ******************************************************************************
+ * @file        : Adafruit_ZeroDMA.h
+ * @brief       : Adafruit Zero DMA stand-in for the simulator
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * A started job fills its destination with ADC readings of the simulated
+ * battery, and completes at the next __WFI().
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+enum dma_beat_size {
+    DMA_BEAT_SIZE_BYTE,
+    DMA_BEAT_SIZE_HWORD,
+    DMA_BEAT_SIZE_WORD
+};
+enum dma_transfer_trigger_action {
+    DMA_TRIGGER_ACTON_BLOCK,
+    DMA_TRIGGER_ACTON_BEAT = 2,
+    DMA_TRIGGER_ACTON_TRANSACTION
+};
+enum ZeroDMAstatus { DMA_STATUS_OK, DMA_STATUS_ERR_NOT_FOUND };
+
+class Adafruit_ZeroDMA {
+   public:
+    using Callback = void (*)(Adafruit_ZeroDMA*);
+
+    void setTrigger(uint8_t /*trigger*/) {}
+    void setAction(dma_transfer_trigger_action /*action*/) {}
+    ZeroDMAstatus allocate() { return DMA_STATUS_OK; }
+    void* addDescriptor(void* src,
+                        void* dst,
+                        uint32_t count,
+                        dma_beat_size size,
+                        bool srcInc,
+                        bool dstInc);
+    void setCallback(Callback callback) { callback_ = callback; }
+    ZeroDMAstatus startJob();
+    void SimComplete();  // called by __WFI()
+
+   private:
+    uint16_t* dst_     = nullptr;
+    uint32_t count_    = 0;
+    Callback callback_ = nullptr;
+};
@@ -0,0 +1,108 @@
+/**
+ ******************************************************************************
+ * @file        : Arduino.h
+ * @brief       : Arduino core stand-in for the simulator
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * The part of the Arduino SAMD core used by the firmware. Time comes from
+ * the virtual clock of the simulator: delay() advances it, and millis() and
+ * micros() read it.
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <type_traits>
+
+#include "sam.h"
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define A1 15
+
+#define PROGMEM
+#define memcpy_P memcpy
+
+// By value, unlike the core, so that static const members are not odr-used
+template <typename T, typename U>
+inline typename std::common_type<T, U>::type min(T a, U b) {
+    return a < b ? a : b;
+}
+
+template <typename T, typename U>
+inline typename std::common_type<T, U>::type max(T a, U b) {
+    return a < b ? b : a;
+}
+
+// The bounds are converted to the type of the value, so that an unsigned
+// value and int bounds do not compare with mixed signedness
+template <typename T>
+inline T constrain(T x, typename std::common_type<T>::type low,
+                   typename std::common_type<T>::type high) {
+    return x < low ? low : (x > high ? high : x);
+}
+
+void pinMode(int pin, int mode);
+void digitalWrite(int pin, int value);
+int digitalRead(int pin);
+int analogRead(int pin);
+
+// C linkage, as in the core, so that they can be wrapped by the linker
+extern "C" {
+unsigned long millis();
+unsigned long micros();
+}
+void delay(unsigned long ms);
+
+void noInterrupts();
+void interrupts();
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+struct PinDescription {
+    uint32_t ulADCChannelNumber;
+};
+
+extern const PinDescription g_APinDescription[];
+
+class Print {
+   public:
+    virtual ~Print() = default;
+    virtual size_t write(uint8_t byte) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    virtual int availableForWrite() { return 0; }
+};
+
+// The serial port, captured by the simulator
+class SimSerial : public Print {
+   public:
+    void begin(unsigned long baud);
+    size_t write(uint8_t byte) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    int availableForWrite() override;
+    explicit operator bool() const { return true; }
+};
+
+extern SimSerial Serial;  // NOLINT
+
+// The sketch
+void setup();
+void loop();
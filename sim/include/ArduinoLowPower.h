@@ -0,0 +1,31 @@
+/**
+ ******************************************************************************
+ * @file        : ArduinoLowPower.h
+ * @brief       : Arduino Low Power stand-in for the simulator
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Sleeping advances the virtual clock, without ticking the timers that stop
+ * in deep sleep.
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+class ArduinoLowPowerClass {
+   public:
+    void idle();  // until the next SysTick interrupt
+    void idle(uint32_t ms);
+    void sleep(uint32_t ms);
+    void deepSleep(uint32_t ms);
+};
+
+extern ArduinoLowPowerClass LowPower;  // NOLINT
@@ -0,0 +1,30 @@
+/**
+ ******************************************************************************
+ * @file        : RTCZero.h
+ * @brief       : RTCZero stand-in for the simulator
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * The RTC counts the seconds of the virtual clock, from the start time of
+ * the scenario.
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+class RTCZero {
+   public:
+    void begin(bool resetTime = false);
+    uint32_t getEpoch();
+    uint32_t getY2kEpoch();
+    void setEpoch(uint32_t ts);
+    void setY2kEpoch(uint32_t ts);
+};
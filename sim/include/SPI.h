@@ -0,0 +1,39 @@
+/**
+ ******************************************************************************
+ * @file        : SPI.h
+ * @brief       : SPI stand-in for the simulator
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Declarations only: the simulator drives the coils through the Feather
+ * pins, and the radio is simulated above the SPI bus.
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+#define MSBFIRST 1
+#define SPI_MODE0 0x02
+
+class SPISettings {
+   public:
+    SPISettings(uint32_t /*clock*/, uint8_t /*order*/, uint8_t /*mode*/) {}
+};
+
+class SPIClass {
+   public:
+    void begin() {}
+    void beginTransaction(SPISettings /*settings*/) {}
+    uint8_t transfer(uint8_t /*data*/) { return 0; }
+    void endTransaction() {}
+};
+
+extern SPIClass SPI;  // NOLINT
@@ -0,0 +1,32 @@
+/**
+ ******************************************************************************
+ * @file        : Wire.h
+ * @brief       : Wire stand-in for the simulator
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Declarations only: the simulator drives the coils through the Feather
+ * pins.
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+class TwoWire {
+   public:
+    void begin() {}
+    void setClock(uint32_t /*frequency*/) {}
+    void beginTransmission(uint8_t /*address*/) {}
+    size_t write(uint8_t /*data*/) { return 1; }
+    uint8_t endTransmission() { return 0; }
+};
+
+extern TwoWire Wire;  // NOLINT
@@ -0,0 +1,34 @@
+/**
+ ******************************************************************************
+ * @file        : hal.h
+ * @brief       : LMIC HAL stand-in for the simulator
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Pin mapping of the radio, unused by the simulated LMIC
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <lmic.h>
+
+#define LMIC_UNUSED_PIN 0xff
+
+struct lmic_pinmap {
+    u1_t nss;
+    u1_t rxtx;
+    u1_t rst;
+    u1_t dio[3];
+    u1_t rxtx_rx_active;
+    s1_t rssi_cal;
+    u4_t spi_freq;
+};
+
+extern const lmic_pinmap lmic_pins;
@@ -0,0 +1,158 @@
+/**
+ ******************************************************************************
+ * @file        : lmic.h
+ * @brief       : LMIC stand-in for the simulator
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * The part of the MCCI LMIC API used by the firmware, with the same names
+ * and values. The MAC is simulated at the level of its events: a join takes
+ * one exchange, every uplink opens two RX windows and the network answers
+ * with the downlinks queued by the scenario (see sim/lmic.cpp). In Class B,
+ * the beacons and the ping slots are simulated as well.
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+typedef uint8_t u1_t;
+typedef int8_t s1_t;
+typedef uint16_t u2_t;
+typedef int16_t s2_t;
+typedef uint32_t u4_t;
+typedef int32_t s4_t;
+typedef u4_t devaddr_t;
+typedef u1_t bit_t;
+typedef int64_t s8_t;
+typedef s4_t ostime_t;
+typedef u1_t dr_t;
+
+#define OSTICKS_PER_SEC 62500
+#define sec2osticks(sec) ((ostime_t)(sec) * OSTICKS_PER_SEC)
+#define ms2osticks(ms) ((ostime_t)(((s8_t)(ms) * OSTICKS_PER_SEC) / 1000))
+#define osticks2ms(os) ((s4_t)(((os) * (s8_t)1000) / OSTICKS_PER_SEC))
+
+enum ev_t {
+    EV_SCAN_TIMEOUT = 1,
+    EV_BEACON_FOUND,
+    EV_BEACON_MISSED,
+    EV_BEACON_TRACKED,
+    EV_JOINING,
+    EV_JOINED,
+    EV_RFU1,
+    EV_JOIN_FAILED,
+    EV_REJOIN_FAILED,
+    EV_TXCOMPLETE,
+    EV_LOST_TSYNC,
+    EV_RESET,
+    EV_RXCOMPLETE,
+    EV_LINK_DEAD,
+    EV_LINK_ALIVE,
+    EV_SCAN_FOUND,
+    EV_TXSTART,
+    EV_TXCANCELED,
+    EV_RXSTART,
+    EV_JOIN_TXCOMPLETE
+};
+
+enum {
+    OP_NONE     = 0x0000,
+    OP_SCAN     = 0x0001,
+    OP_TRACK    = 0x0002,
+    OP_JOINING  = 0x0004,
+    OP_TXDATA   = 0x0008,
+    OP_POLL     = 0x0010,
+    OP_REJOIN   = 0x0020,
+    OP_SHUTDOWN = 0x0040,
+    OP_TXRXPEND = 0x0080,
+    OP_RNDTX    = 0x0100,
+    OP_PINGINI  = 0x0200,
+    OP_PINGABLE = 0x0400,
+    OP_NEXTCHNL = 0x0800,
+    OP_LINKDEAD = 0x1000
+};
+
+enum {
+    TXRX_ACK    = 0x80,
+    TXRX_NACK   = 0x40,
+    TXRX_NOPORT = 0x20,
+    TXRX_PORT   = 0x10,
+    TXRX_DNW1   = 0x01,
+    TXRX_DNW2   = 0x02,
+    TXRX_PING   = 0x04
+};
+
+enum { DR_SF12, DR_SF11, DR_SF10, DR_SF9, DR_SF8, DR_SF7, DR_SF7B, DR_FSK };
+
+enum { OFF_DAT_HDR = 0, OFF_DAT_ADDR = 1, OFF_DAT_FCT = 5, OFF_DAT_SEQNO = 6 };
+enum {
+    FCT_ADREN     = 0x80,
+    FCT_ADRACKReq = 0x40,
+    FCT_ACK       = 0x20,
+    FCT_MORE      = 0x10,
+};
+enum { MAX_LEN_FRAME = 255 };
+
+struct lmic_t {
+    u2_t opmode;
+    u1_t txrxFlags;
+    u1_t dataBeg;
+    u1_t dataLen;
+    u1_t frame[MAX_LEN_FRAME];
+    s1_t snr;   // quarter dB
+    s2_t rssi;  // dBm + 64
+    dr_t datarate;
+    s1_t adrTxPow;
+    u1_t adrEnabled;
+    u4_t netid;
+    devaddr_t devaddr;
+    u4_t seqnoUp;
+    u4_t seqnoDn;
+    dr_t dn2Dr;
+    u1_t rx1DrOffset;
+    u1_t rxDelay;
+};
+
+extern lmic_t LMIC;  // NOLINT
+
+enum { RADIO_RST = 0, RADIO_TX = 1, RADIO_RX = 2, RADIO_RXON = 3 };
+
+void os_init();
+void os_runloop_once();
+ostime_t os_getTime();
+bit_t os_queryTimeCriticalJobs(ostime_t time);
+void os_radio(u1_t mode);
+
+void LMIC_reset();
+void LMIC_startJoining();
+int LMIC_setTxData2(u1_t port, u1_t* data, u1_t dlen, u1_t confirmed);
+void LMIC_clrTxData();
+void LMIC_setAdrMode(bit_t enabled);
+void LMIC_setLinkCheckMode(bit_t enabled);
+void LMIC_setDrTxpow(dr_t dr, s1_t txpow);
+void LMIC_setSession(u4_t netid,
+                     devaddr_t devaddr,
+                     const u1_t* nwkKey,
+                     const u1_t* artKey);
+void LMIC_getSessionKeys(u4_t* netid,
+                         devaddr_t* devaddr,
+                         u1_t* nwkKey,
+                         u1_t* artKey);
+bit_t LMIC_enableTracking(u1_t tryBcnInfo);
+void LMIC_disableTracking();
+int LMIC_setPingable(u1_t intvExp);
+void LMIC_stopPingable();
+
+// Implemented by the application
+void onEvent(ev_t event);
+void os_getArtEui(u1_t* buf);
+void os_getDevEui(u1_t* buf);
+void os_getDevKey(u1_t* buf);
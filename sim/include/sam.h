@@ -0,0 +1,237 @@
+/**
+ ******************************************************************************
+ * @file        : sam.h
+ * @brief       : Simulated SAMD21 peripherals
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * The subset of the SAMD21 registers used by the firmware, with the same
+ * names as the CMSIS headers. Most registers are plain memory: the status
+ * bits read as "ready" and the simulator polls the enable bits as the
+ * virtual clock advances. The registers whose writes have side effects
+ * (port set/clear, flash commands, watchdog) are SimRegister, which reports
+ * every write to SimWrite().
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+void SimWrite(const void* reg, uintptr_t value);
+
+template <typename T>
+struct SimRegister {
+    T value;
+
+    SimRegister& operator=(T v) {
+        value = v;
+        SimWrite(this, v);
+        return *this;
+    }
+    SimRegister& operator|=(T v) { return *this = value | v; }
+    SimRegister& operator&=(T v) { return *this = value & v; }
+    operator T() const { return value; }  // NOLINT
+};
+
+template <typename T>
+struct SimPlain {
+    T reg;
+};
+
+struct SimSyncStatus {
+    struct {
+        uint8_t SYNCBUSY;
+    } bit;
+    uint8_t reg;
+};
+
+// PORT
+#define PORT_PINCFG_INEN 0x02
+
+struct PortGroup {
+    SimPlain<uint32_t> DIR;
+    struct {
+        SimRegister<uint32_t> reg;
+    } DIRCLR, DIRSET, OUTCLR, OUTSET;
+    SimPlain<uint32_t> OUT;
+    SimPlain<uint32_t> IN;
+    SimPlain<uint8_t> PINCFG[32];
+};
+
+struct Port {
+    PortGroup Group[2];
+};
+
+// PM
+#define PM_APBCMASK_TC3 (1UL << 11)
+#define PM_APBCMASK_TC4 (1UL << 12)
+#define PM_APBCMASK_TC5 (1UL << 13)
+
+struct Pm {
+    SimPlain<uint32_t> APBCMASK;
+    struct {
+        struct {
+            uint8_t POR, BOD12, BOD33, EXT, WDT, SYST;
+        } bit;
+        uint8_t reg;
+    } RCAUSE;
+};
+
+// GCLK
+#define GCLK_CLKCTRL_CLKEN (1U << 14)
+#define GCLK_CLKCTRL_GEN_GCLK0 (0U << 8)
+#define GCLK_CLKCTRL_GEN_GCLK3 (3U << 8)
+#define GCLK_CLKCTRL_GEN_GCLK4 (4U << 8)
+#define GCLK_CLKCTRL_ID_WDT 0x03U
+#define GCLK_CLKCTRL_ID_TCC2_TC3 0x1BU
+#define GCLK_CLKCTRL_ID_TC4_TC5 0x1CU
+#define GCLK_GENCTRL_ID(value) ((value) & 0xFU)
+#define GCLK_GENCTRL_SRC_OSCULP32K (3U << 8)
+#define GCLK_GENCTRL_GENEN (1U << 16)
+#define GCLK_GENCTRL_DIVSEL (1U << 20)
+#define GCLK_GENCTRL_RUNSTDBY (1U << 21)
+#define GCLK_GENDIV_ID(value) ((value) & 0xFU)
+#define GCLK_GENDIV_DIV(value) ((value) << 8)
+
+struct Gclk {
+    SimPlain<uint16_t> CLKCTRL;
+    SimPlain<uint32_t> GENCTRL;
+    SimPlain<uint32_t> GENDIV;
+    SimSyncStatus STATUS;
+};
+
+// TC
+#define TC_CTRLA_ENABLE (1U << 1)
+#define TC_CTRLA_MODE_COUNT16 (0U << 2)
+#define TC_CTRLA_MODE_COUNT32 (2U << 2)
+#define TC_CTRLA_WAVEGEN_MFRQ (1U << 5)
+#define TC_CTRLA_PRESCALER_DIV8 (3U << 8)
+#define TC_CTRLA_PRESCALER_DIV16 (4U << 8)
+#define TC_READREQ_RCONT (1U << 14)
+#define TC_READREQ_ADDR(addr) ((addr) & 0x1FU)
+#define TC_INTENSET_MC0 (1U << 4)
+#define TC_INTFLAG_MC0 (1U << 4)
+
+template <typename T>
+struct TcCount {
+    SimPlain<uint16_t> CTRLA;
+    SimPlain<uint16_t> READREQ;
+    SimPlain<uint8_t> INTENSET;
+    SimPlain<uint8_t> INTFLAG;
+    SimSyncStatus STATUS;
+    SimPlain<T> COUNT;
+    SimPlain<T> CC[2];
+};
+
+struct Tc {
+    union {
+        TcCount<uint16_t> COUNT16;
+        TcCount<uint32_t> COUNT32;
+    };
+};
+
+// NVMCTRL
+#define NVMCTRL_CTRLA_CMDEX_KEY (0xA5U << 8)
+#define NVMCTRL_CTRLA_CMD_ER 0x02U
+#define NVMCTRL_CTRLA_CMD_WP 0x04U
+#define NVMCTRL_CTRLA_CMD_PBC 0x44U
+#define NVMCTRL_STATUS_MASK 0x1FU
+
+struct Nvmctrl {
+    struct {
+        SimRegister<uint16_t> reg;
+    } CTRLA;
+    struct {
+        struct {
+            uint8_t MANW;
+        } bit;
+    } CTRLB;
+    struct {
+        struct {
+            uint8_t READY;
+        } bit;
+    } INTFLAG;
+    SimPlain<uint16_t> STATUS;
+    SimPlain<uintptr_t> ADDR;  // a host address, once doubled
+};
+
+// WDT
+#define WDT_CONFIG_PER_16K 0xBU
+#define WDT_CTRL_ENABLE (1U << 1)
+#define WDT_CLEAR_CLEAR_KEY 0xA5U
+
+struct Wdt {
+    struct {
+        SimRegister<uint8_t> reg;
+    } CTRL, CLEAR;
+    SimPlain<uint8_t> CONFIG;
+    SimSyncStatus STATUS;
+};
+
+// ADC, sampled by the simulated DMA (see Adafruit_ZeroDMA.h)
+#define ADC_DMAC_ID_RESRDY 0x27
+
+struct Adc {
+    struct {
+        struct {
+            uint8_t ENABLE;
+        } bit;
+    } CTRLA;
+    struct {
+        struct {
+            uint8_t FREERUN;
+        } bit;
+    } CTRLB;
+    struct {
+        struct {
+            uint8_t MUXPOS;
+        } bit;
+    } INPUTCTRL;
+    struct {
+        struct {
+            uint8_t START;
+        } bit;
+    } SWTRIG;
+    SimSyncStatus STATUS;
+    SimPlain<uint16_t> RESULT;
+};
+
+// SCB: ArduinoLowPower sets SLEEPDEEP for standby and leaves it set, so
+// that the next __WFI() enters standby as well
+#define SCB_SCR_SLEEPDEEP_Msk (1UL << 2)
+
+struct Scb {
+    uint32_t SCR;
+};
+
+extern Port* const PORT;
+extern Pm* const PM;
+extern Gclk* const GCLK;
+extern Tc* const TC3;
+extern Tc* const TC4;
+extern Nvmctrl* const NVMCTRL;
+extern Wdt* const WDT;
+extern Adc* const ADC;
+extern Scb* const SCB;
+
+// NVIC and PRIMASK
+enum IRQn_Type { TC3_IRQn = 18, TC4_IRQn = 19 };
+
+extern "C" void TC3_Handler();
+
+void NVIC_EnableIRQ(IRQn_Type irq);
+void NVIC_DisableIRQ(IRQn_Type irq);
+void NVIC_ClearPendingIRQ(IRQn_Type irq);
+[[noreturn]] void NVIC_SystemReset();
+uint32_t __get_PRIMASK();
+void __set_PRIMASK(uint32_t primask);
+void __disable_irq();
+void __enable_irq();
+void __WFI();
@@ -0,0 +1,103 @@
+/**
+ ******************************************************************************
+ * @file        : main.cpp
+ * @brief       : Simulator entry point
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Run the firmware through a scenario and print the regression metrics.
+ *
+ * Usage: program SCENARIO [TRACE]
+ * The serial output (binary trace records) is written to TRACE if given.
+ ******************************************************************************
+ */
+
+#include <Arduino.h>
+
+#include "network.hpp"
+#include "scenario.hpp"
+#include "sim.hpp"
+
+static void Report() {
+    const Simulator::Metrics& sim = Sim.GetMetrics();
+    const Network::Metrics& net   = Net.GetMetrics();
+    printf("simulated days        : %.2f\n", Sim.Now() / 86400e6);
+    printf("wakeups               : %u\n", sim.wakeups);
+    printf("joins                 : %u\n", net.joins);
+    printf("uplinks               : %u\n", net.uplinks);
+    printf("uplinks lost          : %u\n", net.lost);
+    printf("uplinks hung          : %u\n", net.hung);
+    printf("downlinks             : %u\n", net.downlinks);
+    printf("radio air time (s)    : %.3f\n", net.airTime / 1e3);
+    printf("duty cycle holds      : %u\n", net.dutyCycle);
+    printf("transmissions aborted : %u\n", net.aborted);
+    printf("beacons received      : %u\n", net.beacons);
+    printf("beacons missed        : %u\n", net.beaconsMissed);
+    printf("ping slots            : %u\n", net.pingSlots);
+    printf("ping downlinks        : %u\n", net.pingDownlinks);
+    printf("slots slept over      : %u\n", net.slotsLate);
+    if (net.downlinks > 0) {
+        printf("downlink latency (s)  : mean %.1f, max %.1f\n",
+               net.latencySum / 1e6 / net.downlinks, net.latencyMax / 1e6);
+    }
+    printf("cpu idle (s)          : %.3f\n", sim.idleTime / 1e6);
+    printf("coil on-time (s)      : %.3f\n", sim.coilOnTime / 1e6);
+    printf("coil energy (J)       : %.3f\n", sim.coilEnergy / 1e6);
+    printf("flash row erases      : %u\n", sim.flashErases);
+    printf("tx timeouts           : %u\n", sim.txTimeouts);
+    printf("watchdog resets       : %u\n", sim.resets);
+    printf("deadline closings     : %u\n", sim.closings);
+    if (sim.closings > 0) {
+        printf("deadline error (ms)   : mean %lld, max %lld\n",
+               static_cast<long long>(sim.deadlineErrorSum / sim.closings),
+               static_cast<long long>(sim.deadlineErrorMax));
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "usage: %s SCENARIO [TRACE]\n", argv[0]);
+        return 2;
+    }
+    Scenario scenario;
+    if (!scenario.Load(argv[1])) {
+        return 2;
+    }
+    FILE* trace = nullptr;
+    if (argc == 3) {
+        trace = fopen(argv[2], "wb");
+        if (trace == nullptr) {
+            fprintf(stderr, "%s: cannot open\n", argv[2]);
+            return 2;
+        }
+        Sim.SetTrace(trace);
+    }
+
+    int status = 0;
+    try {
+        scenario.Poll(0);
+        Sim.SetInSetup(true);
+        setup();
+        Sim.SetInSetup(false);
+        while (Sim.Now() < scenario.Duration()) {
+            scenario.Poll(Sim.Now());
+            loop();
+            Sim.Advance(Simulator::kLoopTime);
+        }
+    } catch (const SimReset&) {
+        fprintf(stderr, "reset at %.3f s, end of the run\n", Sim.Now() / 1e6);
+        status = 1;
+    }
+
+    Report();
+    if (trace != nullptr) {
+        fclose(trace);
+    }
+    return status;
+}
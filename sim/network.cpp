@@ -0,0 +1,457 @@
+/**
+ ******************************************************************************
+ * @file        : network.cpp
+ * @brief       : Simulated LoRaWAN MAC and network
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Simulated LoRaWAN MAC and network, and the LMIC stand-in on top of it
+ ******************************************************************************
+ */
+
+#include "network.hpp"
+
+#include <Arduino.h>
+
+#include "sim.hpp"
+#include "uplink.hpp"
+
+static const int kJoinRequestSize = 23;
+static const int kJoinAcceptSize  = 17;
+static const int kFrameOverhead   = 13;    // MHDR, FHDR, FPort, MIC
+static const uint32_t kRx1Delay   = 1000;  // ms
+static const uint32_t kRx2End     = 2100;  // ms, RX2 window included
+static const uint32_t kJoinDelay  = 5000;  // ms
+static const int kDataOffset      = 9;     // MHDR, FHDR without FOpts, FPort
+
+// NOLINTBEGIN(*-global-variables)
+lmic_t LMIC;
+Network Net;
+static u1_t sessionNwkKey[16];
+static u1_t sessionArtKey[16];
+// NOLINTEND(*-global-variables)
+
+Network::Network()
+    : events_{},
+      nEvents_(0),
+      queue_{},
+      nQueued_(0),
+      rx_(false),
+      received_{},
+      lose_(0),
+      hang_(0),
+      snr_(8),     // NOLINT
+      rssi_(-90),  // NOLINT
+      txLen_(0),
+      nextAllowed_(0),
+      beacons_(true),
+      scanEnd_(0),
+      nextBeacon_(0),
+      missedBeacons_(0),
+      pingPeriod_(0),
+      nextPing_(0),
+      metrics_{} {}
+
+void Network::Queue(u1_t port, const u1_t* data, int len) {
+    if (nQueued_ == kMaxQueue || len > kMaxPayload) {
+        return;
+    }
+    Downlink& downlink = queue_[nQueued_++];
+    downlink.queuedAt  = Sim.Now();
+    downlink.port      = port;
+    downlink.len       = len;
+    memcpy(downlink.data, data, len);
+}
+
+void Network::Lose(int uplinks) { lose_ = uplinks; }
+
+void Network::Hang(int uplinks) { hang_ = uplinks; }
+
+void Network::SetLink(int snr, int rssi) {
+    snr_  = snr;
+    rssi_ = rssi;
+}
+
+void Network::SetBeacons(bool on) { beacons_ = on; }
+
+void Network::Reset() {
+    nEvents_    = 0;
+    rx_         = false;
+    scanEnd_    = 0;
+    nextBeacon_ = 0;
+    nextPing_   = 0;
+}
+
+void Network::Post(uint64_t delay, Action action) {
+    if (nEvents_ == kMaxEvents) {
+        return;
+    }
+    // Keep the events sorted by time
+    uint64_t at = Sim.Now() + delay;
+    int i       = nEvents_++;
+    while (i > 0 && events_[i - 1].at > at) {
+        events_[i] = events_[i - 1];
+        i--;
+    }
+    events_[i] = {at, action};
+}
+
+// As LMIC, hold the transmission back until the duty cycle allows it
+uint32_t Network::Send(int len, uint64_t* delay) {
+    int dr       = min(static_cast<int>(LMIC.datarate), DR_SF7);
+    uint32_t air = AirTime(12 - dr, len);  // NOLINT
+    uint64_t now = Sim.Now();
+    *delay       = 0;
+    if (now < nextAllowed_) {
+        *delay = nextAllowed_ - now;
+        metrics_.dutyCycle++;
+    }
+    nextAllowed_ = now + *delay + air * 1000ULL * kDutyCycle;  // NOLINT
+    metrics_.airTime += air;
+    return air;
+}
+
+void Network::Transmit(u1_t /* port */, int len) {
+    txLen_ = len;
+    LMIC.opmode |= OP_TXDATA | OP_TXRXPEND;
+    if (LMIC.devaddr != 0) {
+        SendData();
+        return;
+    }
+    LMIC.opmode |= OP_JOINING;
+    Post(0, kJoining);
+    metrics_.joins++;
+    uint64_t delay;
+    uint32_t air = Send(kJoinRequestSize, &delay);
+    Post(delay, kTxStart);
+    if (lose_ > 0) {
+        lose_--;
+        metrics_.lost++;
+        Post(delay + (air + kJoinDelay + kRx1Delay) * 1000ULL,  // NOLINT
+             kJoinFailed);
+        return;
+    }
+    uint32_t accept = AirTime(12 - LMIC.datarate, kJoinAcceptSize);  // NOLINT
+    Post(delay + (air + kJoinDelay + accept) * 1000ULL, kJoined);    // NOLINT
+}
+
+void Network::SendData() {
+    metrics_.uplinks++;
+    LMIC.seqnoUp++;
+    uint64_t delay;
+    uint32_t air = Send(txLen_ + kFrameOverhead, &delay);
+    Post(delay, kTxStart);
+    if (hang_ > 0) {
+        hang_--;
+        metrics_.hung++;
+        return;  // no completion, the firmware times out
+    }
+    rx_ = false;
+    if (lose_ > 0) {
+        lose_--;
+        metrics_.lost++;
+    } else if (nQueued_ > 0) {
+        rx_       = true;
+        received_ = queue_[0];
+        nQueued_--;
+        memmove(queue_, queue_ + 1, nQueued_ * sizeof(Downlink));
+    }
+    if (rx_) {
+        uint32_t dn = AirTime(12 - LMIC.datarate,  // NOLINT
+                              received_.len + kFrameOverhead);
+        Post(delay + (air + kRx1Delay + dn) * 1000ULL, kTxComplete);  // NOLINT
+    } else {
+        Post(delay + (air + kRx2End) * 1000ULL, kTxComplete);  // NOLINT
+    }
+}
+
+void Network::Cancel() {
+    if ((LMIC.opmode & OP_JOINING) != 0) {
+        return;  // as LMIC, a join is not cancelled
+    }
+    nEvents_ = 0;
+    LMIC.opmode &= ~(OP_TXDATA | OP_TXRXPEND);
+}
+
+void Network::Fire(Action action) {
+    switch (action) {
+        case kJoining:
+            onEvent(EV_JOINING);
+            break;
+
+        case kTxStart:
+            onEvent(EV_TXSTART);
+            break;
+
+        case kJoined: {
+            u1_t nwkKey[sizeof(sessionNwkKey)];
+            u1_t artKey[sizeof(sessionArtKey)];
+            for (size_t i = 0; i < sizeof(nwkKey); i++) {
+                nwkKey[i] = random(256);  // NOLINT
+                artKey[i] = random(256);  // NOLINT
+            }
+            LMIC_setSession(kNetId, kDevAddr, nwkKey, artKey);
+            onEvent(EV_JOINED);
+            SendData();  // the pending uplink
+            break;
+        }
+
+        case kJoinFailed:
+            LMIC.opmode &= ~(OP_JOINING | OP_TXDATA | OP_TXRXPEND);
+            onEvent(EV_JOIN_TXCOMPLETE);
+            break;
+
+        case kTxComplete:
+            LMIC.opmode &= ~(OP_TXDATA | OP_TXRXPEND);
+            LMIC.txrxFlags = 0;
+            LMIC.dataLen   = 0;
+            if (rx_) {
+                Deliver(received_, TXRX_DNW1);
+                rx_ = false;
+            }
+            onEvent(EV_TXCOMPLETE);
+            break;
+
+        default:
+            break;
+    }
+}
+
+void Network::Deliver(const Downlink& downlink, u1_t flags) {
+    uint64_t latency = Sim.Now() - downlink.queuedAt;
+    metrics_.downlinks++;
+    metrics_.latencySum += latency;
+    metrics_.latencyMax = max(metrics_.latencyMax, latency);
+    LMIC.seqnoDn++;
+    LMIC.txrxFlags              = flags | TXRX_PORT;
+    LMIC.frame[OFF_DAT_FCT]     = nQueued_ > 0 ? FCT_MORE : 0;
+    LMIC.frame[kDataOffset - 1] = downlink.port;
+    memcpy(LMIC.frame + kDataOffset, downlink.data, downlink.len);
+    LMIC.dataBeg = kDataOffset;
+    LMIC.dataLen = downlink.len;
+    LMIC.snr     = snr_ * 4;     // NOLINT
+    LMIC.rssi    = rssi_ + 64;  // NOLINT
+}
+
+// Beacons are sent on the multiples of kBeaconPeriod
+void Network::Beacon(uint64_t now) {
+    bool late   = now > nextBeacon_ + kLate;
+    bool heard  = beacons_ && !late;
+    nextBeacon_ = (now / kBeaconPeriod + 1) * kBeaconPeriod;
+    if (late) {
+        metrics_.slotsLate++;
+    }
+    if ((LMIC.opmode & OP_SCAN) != 0) {
+        if (heard) {
+            metrics_.beacons++;
+            missedBeacons_ = 0;
+            scanEnd_       = 0;
+            LMIC.opmode    = (LMIC.opmode & ~OP_SCAN) | OP_TRACK;
+            onEvent(EV_BEACON_FOUND);
+        }
+        return;
+    }
+    if (heard) {
+        metrics_.beacons++;
+        missedBeacons_ = 0;
+        onEvent(EV_BEACON_TRACKED);
+        return;
+    }
+    metrics_.beaconsMissed++;
+    if (++missedBeacons_ <= kLostSync) {
+        onEvent(EV_BEACON_MISSED);
+        return;
+    }
+    // As LMIC, tracking and ping slots stop after about two hours
+    LMIC.opmode &= ~(OP_TRACK | OP_PINGABLE);
+    nextBeacon_ = 0;
+    nextPing_   = 0;
+    onEvent(EV_LOST_TSYNC);
+}
+
+// The first queued downlink, unless an exchange is in progress
+void Network::PingSlot(uint64_t now) {
+    bool late = now > nextPing_ + kLate;
+    nextPing_ += ((now - nextPing_) / pingPeriod_ + 1) * pingPeriod_;
+    if (late) {
+        metrics_.slotsLate++;
+        return;
+    }
+    metrics_.pingSlots++;
+    if (nQueued_ == 0 || (LMIC.opmode & OP_TXRXPEND) != 0) {
+        return;
+    }
+    Downlink downlink = queue_[0];
+    nQueued_--;
+    memmove(queue_, queue_ + 1, nQueued_ * sizeof(Downlink));
+    metrics_.pingDownlinks++;
+    Deliver(downlink, TXRX_PING);
+    onEvent(EV_RXCOMPLETE);
+}
+
+void Network::Run() {
+    while (nEvents_ > 0 && events_[0].at <= Sim.Now()) {
+        Action action = events_[0].action;
+        nEvents_--;
+        memmove(events_, events_ + 1, nEvents_ * sizeof(Event));
+        Fire(action);
+    }
+    uint64_t now = Sim.Now();
+    if (nextBeacon_ != 0 && nextBeacon_ <= now) {
+        Beacon(now);
+    }
+    if (scanEnd_ != 0 && scanEnd_ <= now) {
+        LMIC.opmode &= ~OP_SCAN;
+        scanEnd_    = 0;
+        nextBeacon_ = 0;
+        onEvent(EV_SCAN_TIMEOUT);
+    }
+    if (nextPing_ != 0 && nextPing_ <= now) {
+        PingSlot(now);
+    }
+}
+
+const Network::Metrics& Network::GetMetrics() const { return metrics_; }
+
+// LMIC stand-in
+bool Network::Due(uint64_t within) const {
+    uint64_t limit = Sim.Now() + within;
+    return (nEvents_ > 0 && events_[0].at <= limit) ||
+           (nextBeacon_ != 0 && nextBeacon_ <= limit) ||
+           (scanEnd_ != 0 && scanEnd_ <= limit) ||
+           (nextPing_ != 0 && nextPing_ <= limit);
+}
+
+// As the SX1276 in sleep mode, a transmission in progress is lost, and so
+// is a beacon scan
+void Network::SleepRadio() {
+    if ((LMIC.opmode & OP_TXRXPEND) != 0 && (LMIC.opmode & OP_JOINING) == 0) {
+        metrics_.aborted++;
+        Cancel();
+    }
+    if ((LMIC.opmode & OP_SCAN) != 0) {
+        metrics_.aborted++;
+        Track(false);
+    }
+}
+
+void Network::Track(bool enable) {
+    if (!enable) {
+        LMIC.opmode &= ~(OP_SCAN | OP_TRACK);
+        scanEnd_    = 0;
+        nextBeacon_ = 0;
+        Ping(-1);
+        return;
+    }
+    if ((LMIC.opmode & (OP_SCAN | OP_TRACK)) != 0) {
+        return;
+    }
+    uint64_t now = Sim.Now();
+    LMIC.opmode |= OP_SCAN;
+    scanEnd_    = now + kScanTime;
+    nextBeacon_ = (now / kBeaconPeriod + 1) * kBeaconPeriod;
+}
+
+// Ping slots on the multiples of the period, from the next beacon
+void Network::Ping(int periodicity) {
+    if (periodicity < 0) {
+        LMIC.opmode &= ~OP_PINGABLE;
+        nextPing_ = 0;
+        return;
+    }
+    LMIC.opmode |= OP_PINGABLE;
+    pingPeriod_ = (1ULL << periodicity) * 1000000;  // NOLINT
+    nextPing_   = (Sim.Now() / kBeaconPeriod + 1) * kBeaconPeriod;
+}
+
+void os_init() { LMIC_reset(); }
+
+void os_runloop_once() { Net.Run(); }
+
+ostime_t os_getTime() {
+    return static_cast<ostime_t>(micros() / (1000000 / OSTICKS_PER_SEC));
+}
+
+bit_t os_queryTimeCriticalJobs(ostime_t time) {
+    return Net.Due(static_cast<uint64_t>(time) * 1000000 / OSTICKS_PER_SEC);
+}
+
+void os_radio(u1_t mode) {
+    if (mode == RADIO_RST) {
+        Net.SleepRadio();
+    }
+}
+
+void LMIC_reset() {
+    memset(&LMIC, 0, sizeof(LMIC));
+    LMIC.datarate = DR_SF7;
+    LMIC.adrTxPow = 14;  // NOLINT
+    LMIC.dn2Dr    = DR_SF12;
+    LMIC.rxDelay  = 1;
+    Net.Reset();
+}
+
+void LMIC_startJoining() {}
+
+int LMIC_setTxData2(u1_t port, u1_t* /* data */, u1_t dlen, u1_t /* conf */) {
+    if ((LMIC.opmode & OP_TXRXPEND) != 0) {
+        return -1;
+    }
+    Net.Transmit(port, dlen);
+    return 0;
+}
+
+void LMIC_clrTxData() { Net.Cancel(); }
+
+void LMIC_setAdrMode(bit_t enabled) { LMIC.adrEnabled = enabled; }
+
+void LMIC_setLinkCheckMode(bit_t /* enabled */) {}
+
+void LMIC_setDrTxpow(dr_t dr, s1_t txpow) {
+    LMIC.datarate = dr;
+    LMIC.adrTxPow = txpow;
+}
+
+void LMIC_setSession(u4_t netid,
+                     devaddr_t devaddr,
+                     const u1_t* nwkKey,
+                     const u1_t* artKey) {
+    LMIC.netid   = netid;
+    LMIC.devaddr = devaddr;
+    memcpy(sessionNwkKey, nwkKey, sizeof(sessionNwkKey));
+    memcpy(sessionArtKey, artKey, sizeof(sessionArtKey));
+    LMIC.opmode &= ~OP_JOINING;
+}
+
+void LMIC_getSessionKeys(u4_t* netid,
+                         devaddr_t* devaddr,
+                         u1_t* nwkKey,
+                         u1_t* artKey) {
+    *netid   = LMIC.netid;
+    *devaddr = LMIC.devaddr;
+    memcpy(nwkKey, sessionNwkKey, sizeof(sessionNwkKey));
+    memcpy(artKey, sessionArtKey, sizeof(sessionArtKey));
+}
+
+bit_t LMIC_enableTracking(u1_t /* tryBcnInfo */) {
+    Net.Track(true);
+    return 1;
+}
+
+void LMIC_disableTracking() { Net.Track(false); }
+
+int LMIC_setPingable(u1_t intvExp) {
+    if (intvExp > 7) {  // NOLINT
+        return -1;
+    }
+    Net.Ping(intvExp);
+    return 0;
+}
+
+void LMIC_stopPingable() { Net.Ping(-1); }
@@ -0,0 +1,127 @@
+/**
+ ******************************************************************************
+ * @file        : network.hpp
+ * @brief       : Simulated LoRaWAN MAC and network
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Scriptable event source behind the LMIC stand-in. A join is one request
+ * and its accept in RX1, 5 s later. An uplink takes its time on air, then
+ * gets the first queued downlink in RX1 (1 s later) or ends after RX2. The
+ * scenario queues the downlinks, sets the link quality, and makes the next
+ * uplinks lost (completed without downlink) or hung (never completed, so
+ * that the firmware times out).
+ *
+ * In Class B, the gateways send a beacon every 128 s (unless the scenario
+ * turns them off), and the first queued downlink goes in the next ping
+ * slot. A beacon or a ping slot handled more than kLate after its time was
+ * slept over: it is missed.
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <lmic.h>
+
+class Network {
+   public:
+    static const int kMaxQueue          = 16;
+    static const int kMaxEvents         = 8;
+    static const int kMaxPayload        = 64;
+    static const u4_t kNetId            = 0x13;
+    static const devaddr_t kDevAddr     = 0x260B1234;
+    static const uint64_t kBeaconPeriod = 128000000;  // us
+    static const uint64_t kScanTime     = 129000000;  // us
+    static const uint64_t kLate         = 10000;      // us
+    static const int kLostSync          = 56;         // missed beacons, 2 hours
+
+    struct Metrics {
+        uint32_t joins;
+        uint32_t uplinks;
+        uint32_t downlinks;
+        uint32_t lost;
+        uint32_t hung;
+        uint32_t dutyCycle;      // uplinks held back by the 1% duty cycle
+        uint32_t aborted;        // radio put to sleep during a transmission
+        uint64_t airTime;        // ms
+        uint32_t beacons;        // received
+        uint32_t beaconsMissed;  // not sent, or slept over
+        uint32_t pingSlots;      // opened
+        uint32_t pingDownlinks;
+        uint32_t slotsLate;      // beacons and ping slots slept over
+        uint64_t latencySum;     // us, from queued to received
+        uint64_t latencyMax;     // us
+    };
+
+    Network();
+
+    // Scenario side
+    void Queue(u1_t port, const u1_t* data, int len);
+    void Lose(int uplinks);
+    void Hang(int uplinks);
+    void SetLink(int snr, int rssi);
+    void SetBeacons(bool on);
+
+    // LMIC side
+    void Reset();
+    void Transmit(u1_t port, int len);
+    void Cancel();
+    void Run();
+    bool Due(uint64_t within) const;  // an event within `within` us
+    void SleepRadio();
+    void Track(bool enable);
+    void Ping(int periodicity);  // -1 to stop
+
+    const Metrics& GetMetrics() const;
+
+   private:
+    enum Action { kJoining, kTxStart, kJoined, kJoinFailed, kTxComplete };
+
+    struct Event {
+        uint64_t at;  // us
+        Action action;
+    };
+
+    struct Downlink {
+        uint64_t queuedAt;  // us
+        u1_t port;
+        u1_t len;
+        u1_t data[kMaxPayload];
+    };
+
+    void Post(uint64_t delay, Action action);
+    uint32_t Send(int len, uint64_t* delay);  // time on air in ms
+    void SendData();
+    void Fire(Action action);
+    void Deliver(const Downlink& downlink, u1_t flags);
+    void Beacon(uint64_t now);
+    void PingSlot(uint64_t now);
+
+    Event events_[kMaxEvents];
+    int nEvents_;
+    Downlink queue_[kMaxQueue];
+    int nQueued_;
+    bool rx_;  // a downlink is received in RX1
+    Downlink received_;
+    int lose_;
+    int hang_;
+    int snr_;   // dB
+    int rssi_;  // dBm
+    int txLen_;
+    uint64_t nextAllowed_;  // us, duty cycle
+    bool beacons_;
+    uint64_t scanEnd_;     // us, 0 if not scanning
+    uint64_t nextBeacon_;  // us, 0 if neither scanning nor tracking
+    int missedBeacons_;    // consecutive
+    uint64_t pingPeriod_;  // us
+    uint64_t nextPing_;    // us, 0 if not pingable
+    Metrics metrics_;
+};
+
+extern Network Net;  // NOLINT
@@ -0,0 +1,198 @@
+/**
+ ******************************************************************************
+ * @file        : scenario.cpp
+ * @brief       : Simulation scenario
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Simulation scenario
+ ******************************************************************************
+ */
+
+#include "scenario.hpp"
+
+#include "network.hpp"
+#include "sim.hpp"
+
+static const uint64_t kDefaultDuration = 7ULL * 24 * 3600 * 1000000;
+
+Scenario::Scenario() : actions_{}, nActions_(0), duration_(kDefaultDuration) {}
+
+static bool ParseTime(const char* text, uint64_t* us) {
+    char* end;
+    double value = strtod(text, &end);
+    double unit  = 0;
+    switch (*end) {
+        case 's':
+            unit = 1;
+            break;
+        case 'm':
+            unit = 60;  // NOLINT
+            break;
+        case 'h':
+            unit = 3600;  // NOLINT
+            break;
+        case 'd':
+            unit = 86400;  // NOLINT
+            break;
+        default:
+            return false;
+    }
+    if (end == text || end[1] != '\0' || value < 0) {
+        return false;
+    }
+    *us = static_cast<uint64_t>(value * unit * 1e6);  // NOLINT
+    return true;
+}
+
+static bool ParseInt(const char* text, int* value) {
+    char* end;
+    *value = static_cast<int>(strtol(text, &end, 0));
+    return text != nullptr && end != text && *end == '\0';
+}
+
+bool Scenario::Parse(char* line, Action* action) {
+    const char* word = strtok(line, " \t");
+    action->at       = 0;
+    action->every    = 0;
+    if (strcmp(word, "at") == 0 || strcmp(word, "every") == 0) {
+        uint64_t time;
+        if (!ParseTime(strtok(nullptr, " \t"), &time)) {
+            return false;
+        }
+        if (word[0] == 'a') {
+            action->at = time;
+        } else {
+            action->at    = time;
+            action->every = time;
+        }
+        word = strtok(nullptr, " \t");
+        if (word == nullptr) {
+            return false;
+        }
+    }
+
+    const char* arg = strtok(nullptr, " \t");
+    if (strcmp(word, "battery") == 0) {
+        action->kind = kBattery;
+        return arg != nullptr && ParseInt(arg, &action->a);
+    }
+    if (strcmp(word, "lose") == 0 || strcmp(word, "hang") == 0) {
+        action->kind = word[0] == 'l' ? kLose : kHang;
+        return arg != nullptr && ParseInt(arg, &action->a);
+    }
+    if (strcmp(word, "beacons") == 0) {
+        action->kind = kBeacons;
+        action->a    = arg != nullptr && strcmp(arg, "on") == 0;
+        return arg != nullptr && (action->a || strcmp(arg, "off") == 0);
+    }
+    if (strcmp(word, "link") == 0) {
+        action->kind = kLink;
+        const char* rssi = strtok(nullptr, " \t");
+        return arg != nullptr && rssi != nullptr &&
+               ParseInt(arg, &action->a) && ParseInt(rssi, &action->b);
+    }
+    if (strcmp(word, "downlink") == 0) {
+        action->kind = kDownlink;
+        action->len  = 0;
+        if (arg == nullptr || !ParseInt(arg, &action->a)) {
+            return false;
+        }
+        for (const char* hex = strtok(nullptr, " \t"); hex != nullptr;
+             hex             = strtok(nullptr, " \t")) {
+            for (; hex[0] != '\0'; hex += 2) {
+                unsigned byte;
+                if (hex[1] == '\0' || sscanf(hex, "%2x", &byte) != 1 ||
+                    action->len == kMaxPayload) {
+                    return false;
+                }
+                action->data[action->len++] = byte;
+            }
+        }
+        return action->len > 0;
+    }
+    return false;
+}
+
+bool Scenario::Load(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (file == nullptr) {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+    char line[256];  // NOLINT
+    int number = 0;
+    bool ok    = true;
+    while (ok && fgets(line, sizeof(line), file) != nullptr) {
+        number++;
+        char* comment = strchr(line, '#');
+        if (comment != nullptr) {
+            *comment = '\0';
+        }
+        line[strcspn(line, "\r\n")] = '\0';
+        char copy[sizeof(line)];
+        strcpy(copy, line);  // NOLINT
+        const char* word = strtok(copy, " \t");
+        if (word == nullptr) {
+            continue;
+        }
+        if (strcmp(word, "duration") == 0) {
+            const char* time = strtok(nullptr, " \t");
+            ok               = time != nullptr && ParseTime(time, &duration_);
+        } else if (nActions_ == kMaxActions) {
+            ok = false;
+        } else {
+            ok = Parse(line, &actions_[nActions_]);
+            nActions_ += ok ? 1 : 0;
+        }
+        if (!ok) {
+            fprintf(stderr, "%s:%d: invalid statement\n", path, number);
+        }
+    }
+    fclose(file);
+    return ok;
+}
+
+uint64_t Scenario::Duration() const { return duration_; }
+
+void Scenario::Poll(uint64_t now) {
+    for (int i = 0; i < nActions_; i++) {
+        Action& action = actions_[i];
+        while (action.at != UINT64_MAX && action.at <= now) {
+            Run(action);
+            action.at = action.every != 0 ? action.at + action.every
+                                          : UINT64_MAX;
+        }
+    }
+}
+
+void Scenario::Run(const Action& action) {
+    switch (action.kind) {
+        case kBattery:
+            Sim.SetBattery(action.a);
+            break;
+        case kLink:
+            Net.SetLink(action.a, action.b);
+            break;
+        case kDownlink:
+            Net.Queue(action.a, action.data, action.len);
+            break;
+        case kLose:
+            Net.Lose(action.a);
+            break;
+        case kHang:
+            Net.Hang(action.a);
+            break;
+        case kBeacons:
+            Net.SetBeacons(action.a != 0);
+            break;
+        default:
+            break;
+    }
+}
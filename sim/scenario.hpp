@@ -0,0 +1,65 @@
+/**
+ ******************************************************************************
+ * @file        : scenario.hpp
+ * @brief       : Simulation scenario
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Simulation scenario, read from a text file. One statement per line, '#'
+ * starts a comment. Times are numbers with a unit: s, m, h or d.
+ *
+ *   duration TIME                  length of the simulation
+ *   [at TIME | every TIME] ACTION  when to run the action (default: start)
+ *
+ * Actions:
+ *   battery MV                     battery voltage
+ *   link SNR RSSI                  quality of the downlinks, in dB and dBm
+ *   downlink PORT HEX...           queue a downlink (hex bytes)
+ *   lose N                         the next N uplinks are not received
+ *   hang N                         the next N uplinks never complete
+ *   beacons on|off                 the gateways send beacons (default: on)
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+class Scenario {
+   public:
+    static const int kMaxActions = 64;
+    static const int kMaxPayload = 64;
+
+    Scenario();
+    // Return false, after printing the error, if the file is invalid
+    bool Load(const char* path);
+    uint64_t Duration() const;  // us
+    // Run the actions due at `now`
+    void Poll(uint64_t now);
+
+   private:
+    enum Kind { kBattery, kLink, kDownlink, kLose, kHang, kBeacons };
+
+    struct Action {
+        uint64_t at;     // us
+        uint64_t every;  // us, 0 if once
+        Kind kind;
+        int a;
+        int b;
+        uint8_t data[kMaxPayload];
+        int len;
+    };
+
+    bool Parse(char* line, Action* action);
+    void Run(const Action& action);
+
+    Action actions_[kMaxActions];
+    int nActions_;
+    uint64_t duration_;
+};
@@ -0,0 +1,410 @@
+/**
+ ******************************************************************************
+ * @file        : sim.cpp
+ * @brief       : Discrete-event simulator of the board
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Discrete-event simulator of the board, and the Arduino core, RTCZero,
+ * Arduino Low Power and Adafruit Zero DMA stand-ins that it drives.
+ ******************************************************************************
+ */
+
+#include "sim.hpp"
+
+#include <ArduinoLowPower.h>
+#include <RTCZero.h>
+#include <SPI.h>
+#include <Wire.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <Adafruit_ZeroDMA.h>
+
+#include "battery.hpp"
+#include "trace.hpp"
+
+// NOLINTBEGIN(*-global-variables)
+Simulator Sim;
+SimSerial Serial;
+SPIClass SPI;
+TwoWire Wire;
+ArduinoLowPowerClass LowPower;
+
+static Port port;
+static Pm pm;
+static Gclk gclk;
+static Tc tc3;
+static Tc tc4;
+static Nvmctrl nvmctrl;
+static Wdt wdt;
+static Adc adc;
+static Scb scb;
+
+Port* const PORT       = &port;
+Pm* const PM           = &pm;
+Gclk* const GCLK       = &gclk;
+Tc* const TC3          = &tc3;
+Tc* const TC4          = &tc4;
+Nvmctrl* const NVMCTRL = &nvmctrl;
+Wdt* const WDT         = &wdt;
+Adc* const ADC         = &adc;
+Scb* const SCB         = &scb;
+
+const PinDescription g_APinDescription[] = {
+    {0xFF}, {0xFF}, {0xFF}, {0xFF}, {0xFF}, {0xFF}, {0xFF}, {0xFF},
+    {0xFF}, {0xFF}, {0xFF}, {0xFF}, {0xFF}, {0xFF}, {0},    {2},
+    {3},    {4},    {5},    {10},   {0xFF}, {0xFF}, {0xFF}, {0xFF}};
+
+static uint32_t primask              = 0;
+static Adafruit_ZeroDMA* pendingDma  = nullptr;
+// NOLINTEND(*-global-variables)
+
+Simulator::Simulator()
+    : now_(0),
+      sysTick_(0),
+      tc4_(0),
+      inSetup_(false),
+      battery_(kBattery),
+      trace_(nullptr),
+      metrics_{},
+      watchdogPeriod_(0),
+      watchdogFed_(0),
+      record_{},
+      recordLen_(0),
+      traceTime_(0) {
+    for (int64_t& deadline : deadline_) {
+        deadline = -1;
+    }
+    nvmctrl.INTFLAG.bit.READY = 1;
+}
+
+uint64_t Simulator::Now() const { return now_; }
+
+uint64_t Simulator::SysTick() const { return sysTick_; }
+
+void Simulator::Step(uint64_t us, bool timers) {
+    int lines = 0;
+    for (const PortGroup& group : port.Group) {
+        lines += __builtin_popcount(group.OUT.reg & group.DIR.reg);
+    }
+    metrics_.coilOnTime += lines * us;
+    metrics_.coilEnergy += lines * us * kCoilCurrent * battery_ / 1000000;
+    now_ += us;
+    if (timers) {
+        sysTick_ += us;
+    }
+    if (timers && (tc4.COUNT32.CTRLA.reg & TC_CTRLA_ENABLE) != 0) {
+        tc4_ += us;
+        tc4.COUNT32.COUNT.reg = tc4_;
+    }
+    // The watchdog runs in standby as well
+    if (watchdogPeriod_ != 0 && now_ - watchdogFed_ > watchdogPeriod_) {
+        fprintf(stderr, "watchdog not fed for %.3f s\n",
+                (now_ - watchdogFed_) / 1e6);
+        metrics_.resets++;
+        throw SimReset();
+    }
+}
+
+void Simulator::Advance(uint64_t us) {
+    uint64_t end = now_ + us;
+    while (now_ < end) {
+        if ((tc3.COUNT16.CTRLA.reg & TC_CTRLA_ENABLE) == 0) {
+            Step(end - now_, true);
+            break;
+        }
+        // TC3 interrupt on every millisecond boundary
+        uint64_t tick = (now_ / 1000 + 1) * 1000;  // NOLINT
+        if (tick > end) {
+            Step(end - now_, true);
+            break;
+        }
+        Step(tick - now_, true);
+        TC3_Handler();
+    }
+}
+
+void Simulator::Idle(uint64_t us) {
+    metrics_.idleTime += us;
+    Advance(us);
+}
+
+void Simulator::Sleep(uint64_t us, bool deep) {
+    if (!inSetup_) {
+        metrics_.wakeups++;
+    }
+    if (deep) {
+        Step(us, false);
+    } else {
+        Advance(us);
+    }
+}
+
+void Simulator::SetInSetup(bool inSetup) { inSetup_ = inSetup; }
+
+void Simulator::SetBattery(uint16_t millivolts) { battery_ = millivolts; }
+
+uint16_t Simulator::Battery() const { return battery_; }
+
+void Simulator::SetTrace(FILE* file) { trace_ = file; }
+
+void Simulator::OnSerialBegin() { traceTime_ = now_ / 1000; }  // NOLINT
+
+static bool GetVar(const uint8_t* p, int len, int* pos, uint32_t* value) {
+    *value    = 0;
+    int shift = 0;
+    while (*pos < len) {
+        uint8_t byte = p[(*pos)++];
+        *value |= static_cast<uint32_t>(byte & 0x7F) << shift;  // NOLINT
+        shift += 7;                                             // NOLINT
+        if (byte < 0x80) {                                      // NOLINT
+            return true;
+        }
+    }
+    return false;
+}
+
+// Reassemble the trace records, see lib/trace/trace.hpp
+void Simulator::OnSerial(const uint8_t* data, size_t len) {
+    if (trace_ != nullptr) {
+        fwrite(data, 1, len, trace_);
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (recordLen_ == 0 && data[i] != TraceBuffer::kSync) {
+            continue;
+        }
+        record_[recordLen_++] = data[i];
+        if (recordLen_ < 3 || recordLen_ < 3 + record_[2]) {
+            continue;
+        }
+        int32_t args[TraceBuffer::kMaxArgs];
+        int n   = 0;
+        int pos = 0;
+        uint32_t value;
+        GetVar(record_ + 3, record_[2], &pos, &value);
+        traceTime_ += value;
+        while (n < TraceBuffer::kMaxArgs &&
+               GetVar(record_ + 3, record_[2], &pos, &value)) {
+            args[n++] = static_cast<int32_t>(value >> 1) ^
+                        -static_cast<int32_t>(value & 1);
+        }
+        OnTraceRecord(record_[1], args, n);
+        recordLen_ = 0;
+    }
+}
+
+// A valve closing more than a second before its deadline was closed by a
+// command: only the closings at the deadline are measured.
+void Simulator::OnTraceRecord(int id, const int32_t* args, int n) {
+    auto event = static_cast<TraceEvent>(id);
+    int valve  = n > 0 ? args[0] : -1;
+    bool known = valve >= 0 && valve < kMaxValves;
+    if (event == TraceEvent::TxTimeout) {
+        metrics_.txTimeouts++;
+    } else if (event == TraceEvent::ValveOpening && known) {
+        deadline_[valve] = -1;
+    } else if (event == TraceEvent::ValveCloseScheduled && known && n > 1) {
+        deadline_[valve] = traceTime_ + args[1] * 1000LL;  // NOLINT
+    } else if (event == TraceEvent::ValveClosing && known &&
+               deadline_[valve] >= 0) {
+        int64_t error    = static_cast<int64_t>(traceTime_) - deadline_[valve];
+        deadline_[valve] = -1;
+        if (error < -1000) {  // NOLINT
+            return;
+        }
+        metrics_.closings++;
+        metrics_.deadlineErrorSum += error;
+        if (error > metrics_.deadlineErrorMax) {
+            metrics_.deadlineErrorMax = error;
+        }
+    }
+}
+
+// Registers with side effects
+void Simulator::OnWrite(const void* reg, uintptr_t value) {
+    for (PortGroup& group : port.Group) {
+        if (reg == &group.OUTSET.reg) {
+            group.OUT.reg |= value;
+        } else if (reg == &group.OUTCLR.reg) {
+            group.OUT.reg &= ~value;
+        } else if (reg == &group.DIRSET.reg) {
+            group.DIR.reg |= value;
+        } else if (reg == &group.DIRCLR.reg) {
+            group.DIR.reg &= ~value;
+        } else {
+            continue;
+        }
+        group.IN.reg = group.OUT.reg;
+        return;
+    }
+    if (reg == &nvmctrl.CTRLA.reg &&
+        (value & 0x7F) == NVMCTRL_CTRLA_CMD_ER) {  // NOLINT
+        // The flash area is const: make its row writable, then erase it.
+        // Page writes then go straight to the flash, not to a page buffer.
+        auto* row  = reinterpret_cast<uint8_t*>(nvmctrl.ADDR.reg * 2);
+        long page  = sysconf(_SC_PAGESIZE);
+        auto start = reinterpret_cast<uintptr_t>(row) & ~(page - 1);
+        mprotect(reinterpret_cast<void*>(start),
+                 reinterpret_cast<uintptr_t>(row) + 256 - start,  // NOLINT
+                 PROT_READ | PROT_WRITE);
+        memset(row, 0xFF, 256);  // NOLINT
+        metrics_.flashErases++;
+    } else if (reg == &wdt.CTRL.reg) {
+        watchdogPeriod_ = 0;
+        if ((value & WDT_CTRL_ENABLE) != 0) {
+            uint64_t cycles = 8ULL << wdt.CONFIG.reg;  // NOLINT
+            watchdogPeriod_ = cycles * 1000000 / kWatchdogClock;
+            watchdogFed_    = now_;
+        }
+    } else if (reg == &wdt.CLEAR.reg) {
+        if (value != WDT_CLEAR_CLEAR_KEY) {
+            metrics_.resets++;
+            throw SimReset();
+        }
+        watchdogFed_ = now_;
+    }
+}
+
+const Simulator::Metrics& Simulator::GetMetrics() const { return metrics_; }
+
+void SimWrite(const void* reg, uintptr_t value) { Sim.OnWrite(reg, value); }
+
+// Arduino core
+void pinMode(int /* pin */, int /* mode */) {}
+void digitalWrite(int /* pin */, int /* value */) {}
+int digitalRead(int /* pin */) { return LOW; }
+int analogRead(int /* pin */) { return 0; }
+
+unsigned long millis() { return Sim.SysTick() / 1000; }  // NOLINT
+unsigned long micros() { return Sim.SysTick(); }
+void delay(unsigned long ms) { Sim.Sleep(ms * 1000ULL, false); }  // NOLINT
+
+void noInterrupts() { primask = 1; }
+void interrupts() { primask = 0; }
+uint32_t __get_PRIMASK() { return primask; }
+void __set_PRIMASK(uint32_t value) { primask = value; }
+void __disable_irq() { primask = 1; }
+void __enable_irq() { primask = 0; }
+
+void NVIC_EnableIRQ(IRQn_Type /* irq */) {}
+void NVIC_DisableIRQ(IRQn_Type /* irq */) {}
+void NVIC_ClearPendingIRQ(IRQn_Type /* irq */) {}
+
+void NVIC_SystemReset() {
+    Sim.OnWrite(&wdt.CLEAR.reg, 0);
+    abort();  // not reached
+}
+
+// Wait for an interrupt: the only one awaited is the end of a DMA job. In
+// standby, the ADC clock stops and the job never ends.
+void __WFI() {
+    if ((SCB->SCR & SCB_SCR_SLEEPDEEP_Msk) != 0 && pendingDma != nullptr) {
+        fprintf(stderr, "standby at %.3f s with a DMA job pending\n",
+                Sim.Now() / 1e6);
+        exit(1);
+    }
+    Sim.Advance(1000);  // NOLINT
+    Adafruit_ZeroDMA* dma = pendingDma;
+    pendingDma            = nullptr;
+    if (dma != nullptr) {
+        dma->SimComplete();
+    }
+}
+
+long random(long max) { return max > 0 ? ::random() % max : 0; }
+
+long random(long min, long max) {
+    return min < max ? min + random(max - min) : min;
+}
+
+void randomSeed(unsigned long seed) { srandom(seed); }
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        write(buffer[i]);
+    }
+    return size;
+}
+
+void SimSerial::begin(unsigned long /* baud */) { Sim.OnSerialBegin(); }
+
+size_t SimSerial::write(uint8_t byte) { return write(&byte, 1); }
+
+size_t SimSerial::write(const uint8_t* buffer, size_t size) {
+    Sim.OnSerial(buffer, size);
+    return size;
+}
+
+int SimSerial::availableForWrite() { return 256; }  // NOLINT
+
+// RTCZero, from the start of the simulation
+void RTCZero::begin(bool /* resetTime */) {}
+uint32_t RTCZero::getY2kEpoch() { return Sim.Now() / 1000000; }  // NOLINT
+uint32_t RTCZero::getEpoch() { return getY2kEpoch() + 946684800; }  // NOLINT
+void RTCZero::setEpoch(uint32_t /* ts */) {}
+void RTCZero::setY2kEpoch(uint32_t /* ts */) {}
+
+// Arduino Low Power
+// As the library, idle() clears SLEEPDEEP and the sleeps set it
+void ArduinoLowPowerClass::idle() {
+    SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+    Sim.Idle(1000);  // NOLINT
+}
+
+void ArduinoLowPowerClass::idle(uint32_t ms) {
+    SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+    Sim.Sleep(ms * 1000ULL, false);  // NOLINT
+}
+
+// The RTC alarm matches whole seconds: the MCU wakes up on the second
+// boundary, at least one second later.
+static uint64_t AlarmDelay(uint32_t ms) {
+    uint64_t now     = Sim.Now();
+    uint64_t seconds = max(ms / 1000, 1UL);            // NOLINT
+    return (now / 1000000 + seconds) * 1000000 - now;  // NOLINT
+}
+
+void ArduinoLowPowerClass::sleep(uint32_t ms) {
+    SCB->SCR |= SCB_SCR_SLEEPDEEP_Msk;
+    Sim.Sleep(AlarmDelay(ms), true);
+}
+
+void ArduinoLowPowerClass::deepSleep(uint32_t ms) {
+    SCB->SCR |= SCB_SCR_SLEEPDEEP_Msk;
+    Sim.Sleep(AlarmDelay(ms), true);
+}
+
+// Adafruit Zero DMA: the ADC readings of the battery voltage
+void* Adafruit_ZeroDMA::addDescriptor(void* /* src */,
+                                      void* dst,
+                                      uint32_t count,
+                                      dma_beat_size /* size */,
+                                      bool /* srcInc */,
+                                      bool /* dstInc */) {
+    dst_   = static_cast<uint16_t*>(dst);
+    count_ = count;
+    return dst;
+}
+
+ZeroDMAstatus Adafruit_ZeroDMA::startJob() {
+    pendingDma = this;
+    return DMA_STATUS_OK;
+}
+
+void Adafruit_ZeroDMA::SimComplete() {
+    auto reading = static_cast<uint16_t>(
+        uint32_t{Sim.Battery()} * kAdcMax / (kAdcReference * kVbatDivider));
+    for (uint32_t i = 0; i < count_; i++) {
+        dst_[i] = reading;  // NOLINT
+    }
+    if (callback_ != nullptr) {
+        callback_(this);
+    }
+}
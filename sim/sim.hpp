@@ -0,0 +1,101 @@
+/**
+ ******************************************************************************
+ * @file        : sim.hpp
+ * @brief       : Discrete-event simulator of the board
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Virtual clock and simulated peripherals. Time only moves when the
+ * firmware waits (delay, sleep, __WFI) and by kLoopTime after every call to
+ * loop(), so weeks of operation run in a fraction of a second. While TC3 is
+ * enabled, the clock advances one millisecond at a time and calls its
+ * interrupt handler. In deep sleep, as on the SAMD21, the timers and the
+ * SysTick (millis, micros) stop: only the RTC keeps the time.
+ *
+ * The simulator observes the firmware from the outside: the coil lines on
+ * the PORT registers, the radio (sim/network.cpp) and the trace records on
+ * the serial port, from which it measures how late the valves close.
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+// Thrown by a watchdog or system reset: the run ends there, the globals of
+// the firmware cannot be initialized again.
+struct SimReset {};
+
+class Simulator {
+   public:
+    static const uint64_t kLoopTime    = 1000;  // us, per call to loop()
+    static const uint32_t kCoilCurrent = 200;   // mA
+    static const uint16_t kBattery     = 3900;  // mV, default
+    static const int kMaxValves        = 32;
+    // Hz, the watchdog clock set up by WatchdogBegin() (lib/recovery)
+    static const uint32_t kWatchdogClock = 16;
+
+    struct Metrics {
+        uint32_t wakeups;
+        uint64_t idleTime;         // us
+        uint64_t coilOnTime;       // us, sum over the lines
+        uint64_t coilEnergy;       // uJ
+        uint32_t flashErases;      // rows
+        uint32_t closings;         // valves closed at their deadline
+        int64_t deadlineErrorSum;  // ms
+        int64_t deadlineErrorMax;  // ms
+        uint32_t txTimeouts;
+        uint32_t resets;
+    };
+
+    Simulator();
+
+    uint64_t Now() const;      // us
+    uint64_t SysTick() const;  // us, stopped in deep sleep
+    // Awake: the timers run
+    void Advance(uint64_t us);
+    // CPU idle, the timers run
+    void Idle(uint64_t us);
+    // Deep sleep or delay, counted as a wakeup outside of setup()
+    void Sleep(uint64_t us, bool deep);
+    void SetInSetup(bool inSetup);
+
+    void SetBattery(uint16_t millivolts);
+    uint16_t Battery() const;
+
+    void SetTrace(FILE* file);
+    void OnSerialBegin();
+    void OnSerial(const uint8_t* data, size_t len);
+
+    void OnWrite(const void* reg, uintptr_t value);
+
+    const Metrics& GetMetrics() const;
+
+   private:
+    void Step(uint64_t us, bool timers);
+    void OnTraceRecord(int id, const int32_t* args, int n);
+
+    uint64_t now_;
+    uint64_t sysTick_;
+    uint32_t tc4_;
+    bool inSetup_;
+    uint16_t battery_;
+    FILE* trace_;
+    Metrics metrics_;
+    uint64_t watchdogPeriod_;  // us, 0 while stopped
+    uint64_t watchdogFed_;     // us
+
+    // Trace decoder
+    uint8_t record_[3 + 255];  // NOLINT
+    int recordLen_;
+    uint64_t traceTime_;            // ms
+    int64_t deadline_[kMaxValves];  // ms, -1 if none
+};
+
+extern Simulator Sim;  // NOLINT
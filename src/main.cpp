@@ -16,30 +16,116 @@
  */
 
 #include <Arduino.h>
-#include <ArduinoLog.h>
-#include <ArduinoLowPower.h>
 #include <SPI.h>
+#include <Wire.h>
 #include <hal/hal.h>
 #include <lmic.h>
 #include <math.h>
 #include <stdint.h>
 
 #include "battery.hpp"
+#include "classb.hpp"
+#include "commands.hpp"
+#include "gpio_output.hpp"
+#include "link.hpp"
 #include "lora_logger.hpp"
+#include "mcp23017_output.hpp"
+#include "memory.hpp"
+#include "nvm.hpp"
 #include "payload.hpp"
+#include "profiler.hpp"
+#include "pulse.hpp"
+#include "recovery.hpp"
+#include "schedule.hpp"
+#include "scheduler.hpp"
 #include "secrets.h"
-#include "valve.hpp"
+#include "shift_register_output.hpp"
+#include "sleep.hpp"
+#include "telemetry.hpp"
+#include "trace.hpp"
+#include "uplink.hpp"
+#include "valve_bank.hpp"
 
-#undef LOW_POWER
+// Coil outputs, two lines (open, close) per valve. The backend is selected at
+// build time: Feather pins by default, 74HC595 shift registers with
+// VALVE_OUTPUT_SHIFT_REGISTER, MCP23017 expanders with VALVE_OUTPUT_MCP23017.
+#if defined(VALVE_OUTPUT_SHIFT_REGISTER)
+using Coils = ShiftRegisterOutput<SPIClass, 8>;  // 32 valves
+const int kLatchPin = 12;
+#elif defined(VALVE_OUTPUT_MCP23017)
+using Coils = Mcp23017Output<TwoWire, 4>;  // 32 valves
+#else
+using Coils = GpioOutput<21, 20, 16, 17, 18, 19, 0, 1, 12, 11, 10, 5>;
+#endif
+using Valves = ValveBank<Coils::kLines / 2>;
 
 const int kLedPin                       = 13;
-const int nOfValves                     = 6;
-const uint32_t kSendInterval            = 5 * 60;  // 5 minutes
-const uint32_t kLoopSleep               = 1 * 60;  // 1 minute
-const uint32_t kLoraTransmissionTimeout = 30;      // 30 seconds
+const int nOfValves                     = Valves::kSize;
+const uint32_t kMaxSleep                = 15 * 60;  // 15 minutes
+const uint32_t kLoraTransmissionTimeout = 30;       // 30 seconds
+const uint32_t kSampleInterval          = 10 * 60;  // 10 minutes
+const int kMaxFrameSize                 = 222;      // EU868, DR4 and up
+const int kFOptsReserve                 = 15;       // MAC commands
+const u4_t kFCntReserve                 = 64;       // uplinks between saves
+const int kFrameOverhead                = 13;       // MHDR, FHDR, FPort, MIC
+
+// The loop feeds the watchdog on every wake-up: the longest sleep, with a
+// margin for a late alarm, must fit in its period
+static_assert(kMaxSleep + 60 < kWatchdogTimeout,  // NOLINT
+              "the watchdog would reset a sleeping device");
+const int kRssiOffset                   = 64;       // LMIC.rssi bias
+
+const u1_t kConfigPort      = 2;
+const u1_t kTelemetryPort   = 3;
+const u1_t kDiagnosticsPort = 4;
+const u1_t kValveStatsPort  = 5;
+
+// Timer ids. Valves use their index (0 .. nOfValves-1) as timer id.
+const int kTimerUplink    = nOfValves;
+const int kTimerTxTimeout = nOfValves + 1;
+const int kTimerSample    = nOfValves + 2;
+const int kTimerSchedule  = nOfValves + 3;
+const int kTimerClassB    = nOfValves + 4;
+
+static_assert(kTimerClassB < Scheduler::kMaxTimers, "too many timers");
+
+const uint32_t kUnixToY2k = 946684800;  // seconds from 1970 to 2000
+
+// State kept in flash across resets, so that a reset neither leaves the
+// valves in an unknown state nor triggers a new join.
+struct PersistentState {
+    uint32_t savedAt;  // RTC time
+    // LoRaWAN session, if joined
+    uint8_t joined;
+    uint8_t dn2Dr;
+    uint8_t rx1DrOffset;
+    uint8_t rxDelay;
+    u4_t netid;
+    devaddr_t devaddr;
+    u1_t nwkKey[16];  // NOLINT
+    u1_t appKey[16];  // NOLINT
+    u4_t seqnoUp;     // kFCntReserve ahead of the counter at save time
+    u4_t seqnoDn;
+    // Valves
+    uint32_t openValves;          // bitmask
+    uint32_t closeAt[nOfValves];  // RTC time, or Scheduler::kNever
+    // Clock, schedules and uplink policy
+    uint8_t clockSet;
+    int32_t clockOffset;
+    uint32_t heartbeat;
+    uint16_t hysteresis;
+    Schedule::Entry schedule[Schedule::kMaxEntries];
+    // Transmission recovery counters
+    uint16_t recoveries[TxRecovery::kStages];
+    // Last downlink sequence number, if any
+    uint8_t sequenceSet;
+    uint16_t sequence;
+    // Requested ping-slot periodicity, or ClassBManager::kOff
+    uint8_t classB;
+};
 
-const int kValvePins[nOfValves][2] = {
-    {21, 20}, {16, 17}, {18, 19}, {0, 1}, {12, 11}, {10, 5}};
+static_assert(sizeof(PersistentState) <= Nvm::kMaxData,
+              "persistent state too large");
 
 void os_getArtEui(u1_t* buf) { memcpy_P(buf, kAppEUI, 8); }   // NOLINT
 void os_getDevEui(u1_t* buf) { memcpy_P(buf, kDevEUI, 8); }   // NOLINT
@@ -59,172 +145,899 @@ const lmic_pinmap lmic_pins = {
 };
 
 // NOLINTBEGIN(*-global-variables)
-static uint32_t lastTransmission = 0;
 static bool loraTransmission     = false;
+static bool diagnosticsRequested = false;
+static bool valveStatsRequested  = false;
+static u1_t txPort               = 0;  // port of the last uplink
 
 static RTCZero rtc;
 static Battery battery;
-static Valve* valves[nOfValves];
+static Scheduler scheduler;
+static UplinkPolicy uplinkPolicy;
+static Telemetry telemetry(nOfValves);
+static Schedule schedule;
+static Nvm nvm;
+static LinkManager linkManager;
+static TxRecovery txRecovery;
+static CommandQueue commands;
+static ClassBManager classB;
+
+// The statistics of the valves changed since the last ones delivered are
+// appended to the telemetry frames, when they fit. A change is a coil pulse
+// or a failed close: per valve, the number of changes in the statistics
+// delivered, and in those of the pending uplink.
+static uint16_t statsReported[nOfValves] = {};
+static uint16_t statsSent[nOfValves]     = {};
+static bool statsPending                 = false;
+
+// The state is saved when it has changed and the device is idle. The frame
+// counter is saved ahead by kFCntReserve, so that it is only written once
+// every kFCntReserve uplinks and never goes backwards after a reset.
+static bool stateDirty   = false;
+static u4_t savedSeqnoUp = 0;
+
+// Local time = RTC time + clockOffset, once the clock has been set. The RTC
+// itself is never set, so that the scheduler deadlines stay valid.
+static bool clockSet       = false;
+static int32_t clockOffset = 0;
+#if defined(VALVE_OUTPUT_SHIFT_REGISTER)
+static Coils coils(&SPI, kLatchPin);
+#elif defined(VALVE_OUTPUT_MCP23017)
+static Coils coils(&Wire);
+#else
+static Coils coils;
+#endif
+static Valves valves(&coils, &rtc, &scheduler, &battery);
 // NOLINTEND(*-global-variables)
 
+// Configuration downlink (kConfigPort):
+//   bytes 0-1: heartbeat period in minutes (LSB first, 0 for the default)
+//   bytes 2-3: voltage hysteresis in mV (LSB first, optional)
+void Configure(const uint8_t* data, int len) {
+    if (len < 2) {
+        TRACE(InvalidConfiguration);
+        return;
+    }
+    uint32_t minutes = data[0] | (data[1] << 8);  // NOLINT
+    uplinkPolicy.SetHeartbeat(minutes * 60);      // NOLINT
+    TRACE(HeartbeatSet, uplinkPolicy.Heartbeat());
+    if (len >= 4) {  // NOLINT
+        uint16_t hysteresis = data[2] | (data[3] << 8);  // NOLINT
+        uplinkPolicy.SetHysteresis(hysteresis);
+        TRACE(HysteresisSet, hysteresis);
+    }
+    stateDirty = true;
+}
+
+void OpenValve(int i) {
+    if (valves[i].Open()) {
+        telemetry.AddEvent(rtc.getY2kEpoch(), Telemetry::kOpened, i);
+        stateDirty = true;
+    }
+}
+
+void CloseValve(int i, Telemetry::Kind kind, bool force = false) {
+    if (valves[i].Close(force)) {
+        telemetry.AddEvent(rtc.getY2kEpoch(), kind, i);
+        stateDirty = true;
+    }
+}
+
+// Arm the schedule timer for the next entry to fire. Schedules run on local
+// time and are suspended until the clock has been set.
+void ArmSchedule() {
+    uint32_t next = schedule.Next();
+    if (!clockSet || next == Schedule::kNever) {
+        scheduler.Cancel(kTimerSchedule);
+        return;
+    }
+    scheduler.At(kTimerSchedule, next - clockOffset);
+}
+
+void SetClock(uint32_t unixTime) {
+    uint32_t local = unixTime - kUnixToY2k;
+    clockOffset    = static_cast<int32_t>(local - rtc.getY2kEpoch());
+    clockSet       = true;
+    schedule.Rebase(local);
+    ArmSchedule();
+    TRACE(ClockSet, clockOffset);
+}
+
+void SetSchedule(const Command& command) {
+    Schedule::Entry entry;
+    int slot = Schedule::Parse(command.data, command.len, &entry);
+    if (slot < 0 || entry.valve >= nOfValves) {
+        TRACE(InvalidSchedule);
+        return;
+    }
+    schedule.Set(slot, entry, rtc.getY2kEpoch() + clockOffset);
+    ArmSchedule();
+    TRACE(ScheduleSet,
+          slot,
+          entry.valve,
+          entry.days,
+          entry.start,
+          entry.duration);
+}
+
+void RunSchedule(uint32_t now) {
+    int slot = schedule.PopDue(now + clockOffset);
+    while (slot >= 0) {
+        const Schedule::Entry& entry = schedule.Get(slot);
+        TRACE(ScheduleFired, slot);
+        OpenValve(entry.valve);
+        valves[entry.valve].ScheduleClose(entry.duration);
+        slot = schedule.PopDue(now + clockOffset);
+    }
+    ArmSchedule();
+}
+
+void Execute(const Command& command) {
+    int i = command.valve;
+    switch (command.opcode) {
+        case Command::kOpen:
+        case Command::kClose:
+            if (i >= nOfValves) {
+                TRACE(InvalidValve, i);
+                return;
+            }
+            if (command.opcode == Command::kClose) {
+                CloseValve(i, Telemetry::kClosed);  // no pulse if closed
+                return;
+            }
+            OpenValve(i);
+            if (command.value == 0) {
+                valves[i].CancelClose();  // open until closed
+            } else {
+                valves[i].ScheduleClose(command.value);
+            }
+            break;
+
+        case Command::kSetUplinkInterval:
+            uplinkPolicy.SetHeartbeat(command.value);
+            TRACE(HeartbeatSet, uplinkPolicy.Heartbeat());
+            break;
+
+        case Command::kQuery:
+            if (command.value == kQueryStatus) {
+                uplinkPolicy.Request();
+            } else if (command.value == kQueryDiagnostics) {
+                diagnosticsRequested = true;
+                uplinkPolicy.Request();
+            } else if (command.value == kQueryValves) {
+                valveStatsRequested = true;
+                uplinkPolicy.Request();
+            }
+            break;
+
+        case Command::kSetSchedule:
+            SetSchedule(command);
+            break;
+
+        case Command::kSetTime:
+            SetClock(command.value);
+            break;
+
+        case Command::kSetClassB:
+            classB.Request(command.value);
+            TRACE(ClassBRequested, classB.Requested());
+            break;
+
+        default:
+            TRACE(UnsupportedCommand, command.opcode);
+            break;
+    }
+}
+
+// Queue the commands of a downlink, they are run by the main loop. A
+// replayed downlink is dropped as a whole.
+void HandleDownlink(const uint8_t* data, int len) {
+    Payload payload(data, len);
+    if (!payload.IsValid()) {
+        TRACE(MalformedPayload, len);
+        return;
+    }
+    uint16_t sequence = 0;
+    if (payload.Sequence(&sequence) && !commands.Accept(sequence)) {
+        TRACE(DuplicateDownlink, sequence);
+        return;
+    }
+    TRACE(ValidPayload);
+    Command command;
+    while (payload.Next(&command)) {
+        if (command.opcode == Command::kSequence) {
+            continue;
+        }
+        if (!commands.Push(command)) {
+            TRACE(CommandQueueFull, command.opcode);
+        }
+    }
+    stateDirty = true;
+}
+
+void RunCommands() {
+    CommandQueue::Item item;
+    while (commands.Pop(&item)) {
+        Execute(item.command);
+    }
+}
+
+void SaveSession(PersistentState* state) {
+    state->joined = LMIC.devaddr != 0 && (LMIC.opmode & OP_JOINING) == 0;
+    if (state->joined) {
+        LMIC_getSessionKeys(
+            &state->netid, &state->devaddr, state->nwkKey, state->appKey);
+        state->seqnoUp     = LMIC.seqnoUp;
+        state->seqnoDn     = LMIC.seqnoDn;
+        state->dn2Dr       = LMIC.dn2Dr;
+        state->rx1DrOffset = LMIC.rx1DrOffset;
+        state->rxDelay     = LMIC.rxDelay;
+    }
+}
+
+void RestoreSession(const PersistentState& state) {
+    LMIC_setSession(state.netid, state.devaddr, state.nwkKey, state.appKey);
+    LMIC.seqnoUp     = state.seqnoUp;
+    LMIC.seqnoDn     = state.seqnoDn;
+    LMIC.dn2Dr       = state.dn2Dr;
+    LMIC.rx1DrOffset = state.rx1DrOffset;
+    LMIC.rxDelay     = state.rxDelay;
+}
+
+void SaveState() {
+    PersistentState state;
+    memset(&state, 0, sizeof(state));
+    state.savedAt = rtc.getY2kEpoch();
+
+    SaveSession(&state);
+    if (state.joined) {
+        state.seqnoUp += kFCntReserve;
+    }
+
+    state.openValves = valves.OpenMask();
+    for (int i = 0; i < nOfValves; i++) {
+        state.closeAt[i] = valves[i].CloseDeadline();
+    }
+
+    state.clockSet    = clockSet;
+    state.clockOffset = clockOffset;
+    state.heartbeat   = uplinkPolicy.Heartbeat();
+    state.hysteresis  = uplinkPolicy.Hysteresis();
+    for (int i = 0; i < Schedule::kMaxEntries; i++) {
+        state.schedule[i] = schedule.Get(i);
+    }
+    for (int i = 0; i < TxRecovery::kStages; i++) {
+        auto stage          = static_cast<TxRecovery::Stage>(i);
+        state.recoveries[i] = txRecovery.Count(stage);
+    }
+    state.sequenceSet = commands.HasSequence();
+    state.sequence    = commands.Sequence();
+    state.classB      = classB.Requested();
+
+    if (!nvm.Save(&state, sizeof(state))) {
+        TRACE(SaveFailed);
+        return;
+    }
+    savedSeqnoUp = state.seqnoUp;
+    stateDirty   = false;
+    TRACE(StateSaved);
+}
+
+// Restore the state saved before the reset. Valves that were open stay open
+// (without pulsing the coils) and are closed at the saved deadline.
+bool RestoreState() {
+    PersistentState state;
+    if (!nvm.Load(&state, sizeof(state))) {
+        TRACE(NoSavedState);
+        return false;
+    }
+    uint32_t now = rtc.getY2kEpoch();
+    // The RTC keeps running across a system reset, but restarts from zero
+    // after a power loss. In that case, the time spent off is unknown and
+    // the deadlines are taken relative to the time of the save.
+    bool clockKept = static_cast<int32_t>(now - state.savedAt) >= 0;
+
+    if (state.joined) {
+        RestoreSession(state);
+        savedSeqnoUp = state.seqnoUp;
+        TRACE(SessionRestored, state.seqnoUp);
+    }
+    for (int i = 0; i < TxRecovery::kStages; i++) {
+        txRecovery.SetCount(static_cast<TxRecovery::Stage>(i),
+                            state.recoveries[i]);
+    }
+    if (state.sequenceSet != 0) {
+        commands.Restore(state.sequence);
+    }
+    classB.Request(state.classB);
+
+    for (int i = 0; i < nOfValves; i++) {
+        if ((state.openValves & (1UL << i)) == 0) {
+            continue;
+        }
+        if (state.closeAt[i] == Scheduler::kNever) {
+            valves[i].Restore(true);
+            continue;
+        }
+        auto remaining = static_cast<int32_t>(
+            state.closeAt[i] - (clockKept ? now : state.savedAt));
+        if (remaining <= 0) {
+            telemetry.AddEvent(now, Telemetry::kTimeout, i);
+            continue;  // closed with the others
+        }
+        valves[i].Restore(true);
+        valves[i].ScheduleClose(remaining);
+    }
+
+    uplinkPolicy.SetHeartbeat(state.heartbeat);
+    uplinkPolicy.SetHysteresis(state.hysteresis);
+    // Without the RTC, the local time is lost as well
+    clockSet    = clockKept && state.clockSet;
+    clockOffset = clockSet ? state.clockOffset : 0;
+    for (int i = 0; i < Schedule::kMaxEntries; i++) {
+        schedule.Set(i, state.schedule[i], now + clockOffset);
+    }
+    ArmSchedule();
+    TRACE(StateRestored);
+    return true;
+}
+
+// Ask for a follow-up uplink if the downlink carried commands, to report
+// their effect, or if the network has more downlinks queued.
+void FollowUp() {
+    if ((LMIC.txrxFlags & (TXRX_DNW1 | TXRX_DNW2 | TXRX_PING)) == 0) {
+        return;  // nothing received
+    }
+    bool pending = (LMIC.frame[OFF_DAT_FCT] & FCT_MORE) != 0;
+    if (LMIC.dataLen == 0 && !pending) {
+        return;
+    }
+    if (!uplinkPolicy.FollowUp()) {
+        TRACE(TooManyFollowUps);
+        return;
+    }
+    TRACE(FollowUp, pending);
+}
+
+// Feed the link manager with the quality of the downlink, if any, and apply
+// its decision. LMIC may also have changed the settings (link check).
+void UpdateLink() {
+    if ((LMIC.txrxFlags & TXRX_DNW1) != 0) {
+        int dr = max(linkManager.DataRate() - LMIC.rx1DrOffset, 0);
+        linkManager.OnDownlink(dr, LMIC.snr, LMIC.rssi - kRssiOffset);
+    } else if ((LMIC.txrxFlags & TXRX_DNW2) != 0) {
+        linkManager.OnDownlink(LMIC.dn2Dr, LMIC.snr, LMIC.rssi - kRssiOffset);
+    }
+    linkManager.OnSettings(LMIC.datarate, LMIC.adrTxPow);
+
+    LinkManager::Decision decision = linkManager.Update();
+    if (decision == LinkManager::kKeep) {
+        return;
+    }
+    LMIC_setDrTxpow(linkManager.DataRate(), linkManager.TxPower());
+    TRACE(LinkDecision,
+          decision,
+          linkManager.DataRate(),
+          linkManager.TxPower(),
+          linkManager.Margin(),
+          linkManager.Rssi());
+}
+
+// Downlink received in an RX window or in a ping slot
+void Receive() {
+    FollowUp();
+    if (LMIC.dataLen != 0 && (LMIC.txrxFlags & TXRX_PORT) != 0 &&
+        LMIC.frame[LMIC.dataBeg - 1] == kConfigPort) {
+        Configure(LMIC.frame + LMIC.dataBeg, LMIC.dataLen);
+    } else if (LMIC.dataLen != 0) {
+        HandleDownlink(LMIC.frame + LMIC.dataBeg, LMIC.dataLen);
+    }
+}
+
 void onEvent(ev_t event) {
     LoraLogEvent(event);
     switch (event) {
         case EV_JOINED:
-            // Disable link check validation (automatically enabled
-            // during join, but because slow data rates change max TX
-            // size, we don't use it in this example.
-            LMIC_setLinkCheckMode(0);
+            Profile.Stop(Profiler::kRadio);
+            stateDirty = true;
+            break;
+
+        case EV_TXSTART:
+            Profile.Start(Profiler::kRadio);
+            break;
+
+        case EV_TXCANCELED:
+            Profile.Stop(Profiler::kRadio);
             break;
 
         case EV_JOIN_FAILED:
         case EV_REJOIN_FAILED:
         case EV_JOIN_TXCOMPLETE:
+            Profile.Stop(Profiler::kRadio);
             loraTransmission = false;
+            scheduler.Cancel(kTimerTxTimeout);
             break;
 
         case EV_TXCOMPLETE:
-            if (LMIC.dataLen == (nOfValves + 1) / 2) {
-                Log.infoln("Received valid payload");
-                Payload payload;
-                payload.SetPayload(LMIC.frame + LMIC.dataBeg, LMIC.dataLen);
-                for (int i = 0; i < nOfValves; i++) {
-                    int p = payload.GetPeriod(i);  // NOLINT
-                    if (p == 0) {
-                        Log.infoln("Nothing to do for valve %i", i);
-                        continue;
-                    }
-                    if (p < -1) { // open forever
-                        valves[i]->Open();
-                        continue;
-                    }
-                    if (p < 0) {
-                        valves[i]->Close(true);
-                        continue;
-                    }
-                    // p > 0
-                    valves[i]->Open();
-                    valves[i]->ScheduleClose(p *
-                                             60);  // minute to seconds NOLINT
-                }
-            }
+            Profile.Stop(Profiler::kRadio);
+            txRecovery.OnSuccess();
+            UpdateLink();
+            Receive();
 
+            if (LMIC.seqnoUp >= savedSeqnoUp) {
+                stateDirty = true;
+            }
+            if (txPort == kTelemetryPort) {
+                telemetry.Commit();
+            }
+            if (statsPending) {
+                memcpy(statsReported, statsSent, sizeof(statsReported));
+            }
             loraTransmission = false;
+            scheduler.Cancel(kTimerTxTimeout);
+            break;
+
+        case EV_RXCOMPLETE:  // ping slot
+            Receive();
+            break;
+
+        case EV_SCAN_TIMEOUT:
+            Profile.Stop(Profiler::kRadio);
+            classB.OnScanTimeout(rtc.getY2kEpoch());
+            TRACE(ClassBFallback, classB.RetryAt());
             break;
+
+        case EV_BEACON_FOUND:
+            Profile.Stop(Profiler::kRadio);
+            classB.OnBeaconFound();
+            break;
+
+        case EV_BEACON_TRACKED:
+            classB.OnBeaconTracked();
+            break;
+
+        case EV_BEACON_MISSED:
+            classB.OnBeaconMissed(rtc.getY2kEpoch());
+            break;
+
+        case EV_LOST_TSYNC:
+            classB.OnLostSync(rtc.getY2kEpoch());
+            break;
+
         default:
             break;
     }
 }
 
-void SendLoraPacket() {
+uint32_t ValvesStatus() { return valves.OpenMask(); }
+
+uint16_t Changes(const ValveStats& stats) {
+    return stats.actuations + stats.failedCloses;
+}
+
+// Valves changed since the last statistics delivered
+uint32_t ChangedValves() {
+    uint32_t mask = 0;
+    for (int i = 0; i < nOfValves; i++) {
+        if (Changes(valves[i].Stats()) != statsReported[i]) {
+            mask |= 1UL << i;
+        }
+    }
+    return mask;
+}
+
+// Diagnostics frame: the profile, then, when they fit, the memory report and
+// the last decision and the number of changes of the link manager
+int EncodeDiagnostics(uint8_t* buffer, int size) {
+    bool complete = false;
+    int len       = Profile.Encode(buffer, size, &complete);
+    int n         = complete ? Memory.Encode(buffer + len, size - len) : 0;
+    if (n == 0) {
+        return len;
+    }
+    len += n;
+    uint8_t link[2 * Varint::kMaxSize32];
+    auto decision = static_cast<uint32_t>(linkManager.LastDecision());
+    auto changes  = static_cast<uint32_t>(linkManager.Changes());
+    int m         = Varint::Put(link, sizeof(link), decision);
+    m += Varint::Put(link + m, sizeof(link) - m, changes);
+    if (m > size - len) {
+        return len;
+    }
+    memcpy(buffer + len, link, m);
+    return len + m;
+}
+
+// Statistics of the valves in `mask`, as a block or as a frame of their
+// own, in which case the last valves are left out if it is too short.
+// Return the length, 0 if nothing fits.
+int EncodeValveStats(
+    uint32_t now, uint32_t mask, uint8_t* buffer, int size, bool frame) {
+    ValveStats stats[nOfValves];
+    for (int i = 0; i < nOfValves; i++) {
+        stats[i] = valves[i].Stats();
+    }
+    int len = 0;
+    if (!frame) {
+        len = ValveStatsWriter::Encode(buffer, size, now, mask, stats);
+    }
+    while (frame && mask != 0) {
+        len = ValveStatsWriter::EncodeFrame(buffer, size, now, mask, stats);
+        if (len != 0) {
+            break;
+        }
+        mask &= ~(1UL << (31 - __builtin_clz(mask)));  // NOLINT
+    }
+    if (len == 0) {
+        return 0;
+    }
+    memcpy(statsSent, statsReported, sizeof(statsSent));
+    for (int i = 0; i < nOfValves; i++) {
+        if ((mask & (1UL << i)) != 0) {
+            statsSent[i] = Changes(stats[i]);
+        }
+    }
+    statsPending = true;
+    return len;
+}
+
+// Maximum application payload for the data rate (EU868, no repeater),
+// leaving room for the MAC commands that LMIC may piggyback.
+int MaxPayload(dr_t dr) {
+    static const uint8_t kMaxPayload[] = {51, 51, 51, 115, 222, 222, 222, 222};
+    if (dr >= sizeof(kMaxPayload)) {
+        return kMaxPayload[0] - kFOptsReserve;
+    }
+    return kMaxPayload[dr] - kFOptsReserve;
+}
+
+// Queue the next uplink. An empty frame is only sent as a heartbeat: when
+// nothing fits otherwise, nothing is sent, and the records stay queued for
+// the next uplink. Return false in that case.
+bool SendLoraPacket(uint32_t now,
+                    uint16_t vbat,
+                    uint32_t valvesStatus,
+                    bool heartbeat) {
     // Check if there is not a current TX/RX job running
     if ((LMIC.opmode & OP_TXRXPEND) != 0) {
-        Log.warningln("OP_TXRXPEND, not sending");
-        return;
+        TRACE(TxPending);
+        return true;  // the transmission timeout recovers
     }
-    char buf[32];  // NOLINT
-    uint16_t vbat = battery.Voltage();
-    Log.infoln("Battery voltage: %dV", vbat);
-    uint8_t payload[3];
-    payload[0] = vbat & 0xFF;  // LSB - NOLINT
-    payload[1] = vbat >> 8;    // MSB - NOLINT
+    Profile.Start(Profiler::kSend);
+    TRACE(BatteryVoltage, vbat);
+    telemetry.AddSample(now, vbat, valvesStatus);
 
-    uint8_t valvesStatus = 0;  // NOLINT
-    for (int i = 0; i < nOfValves; i++) {
-        if (valves[i]->IsOpen()) {
-            valvesStatus |= 1 << i;
+    uint8_t payload[kMaxFrameSize];
+    int size     = MaxPayload(LMIC.datarate);
+    int len      = 0;
+    statsPending = false;
+    if (diagnosticsRequested) {
+        diagnosticsRequested = false;
+        txPort               = kDiagnosticsPort;
+        len                  = EncodeDiagnostics(payload, size);
+        TRACE(SendingDiagnostics, len);
+    } else if (valveStatsRequested) {
+        valveStatsRequested = false;
+        txPort              = kValveStatsPort;
+        len = EncodeValveStats(now, Valves::kAll, payload, size, true);
+        TRACE(SendingValveStats, len);
+    } else {
+        txPort = kTelemetryPort;
+        len    = telemetry.Encode(now, payload, size);
+        TRACE(Queuing, len, len > 5 ? payload[5] : 0);  // NOLINT
+        uint32_t changed = ChangedValves();
+        int n            = 0;
+        if (changed != 0) {
+            n = EncodeValveStats(
+                now, changed, payload + len, size - len, false);
         }
+        if (n != 0) {
+            len += n;
+            TRACE(AppendingValveStats, changed, n);
+        }
+    }
+    if (len == 0 && !heartbeat) {
+        TRACE(NothingToSend, txPort);
+        Profile.Stop(Profiler::kSend);
+        return false;
     }
-    payload[2] = valvesStatus;
+    LMIC_setTxData2(txPort, payload, len, 0);
+    if (LMIC.datarate <= DR_SF7) {
+        // Keep the next uplink within the duty cycle, rather than let LMIC
+        // hold it back past the transmission timeout
+        int sf       = 12 - LMIC.datarate;  // NOLINT
+        uint32_t air = AirTime(sf, len + kFOptsReserve + kFrameOverhead);
+        uplinkPolicy.SetAirTime(air);
+        Profile.Add(Profiler::kTx, air * Profiler::kTicksPerMs);
+    }
+    Profile.Stop(Profiler::kSend);
+    return true;
+}
 
-    snprintf(
-        buf, sizeof(buf), "%02X:%02X %02X", payload[0], payload[1], payload[2]);
-    Log.infoln("Queuing packet %s", buf);
-    LMIC_setTxData2(1, payload, sizeof(payload), 0);
+// Send an uplink if the policy asks for one, otherwise arm the uplink timer
+// for the next heartbeat.
+void CheckUplink(uint32_t now) {
+    if (loraTransmission) {
+        return;
+    }
+    uint32_t status = ValvesStatus();
+    battery.Voltage();
+    uint16_t vbat = battery.Average();
+
+    UplinkPolicy::Reason reason = uplinkPolicy.Check(now, status, vbat);
+    if (reason == UplinkPolicy::kNone) {
+        scheduler.At(kTimerUplink, uplinkPolicy.NextHeartbeat());
+        return;
+    }
+    uint32_t earliest = uplinkPolicy.Earliest();
+    if (static_cast<int32_t>(now - earliest) < 0) {
+        scheduler.At(kTimerUplink, earliest);
+        return;
+    }
+
+    TRACE(SendingUplink, reason);
+    scheduler.Cancel(kTimerUplink);
+    bool sent = SendLoraPacket(now, vbat, status,
+                               reason == UplinkPolicy::kHeartbeat);
+    // A skipped uplink counts as sent for the policy, otherwise the same
+    // reason would try again at once: the records go with the next one
+    uplinkPolicy.Sent(now, status, vbat);
+    if (!sent) {
+        scheduler.At(kTimerUplink, uplinkPolicy.NextHeartbeat());
+        return;
+    }
+    loraTransmission = true;
+    scheduler.At(kTimerTxTimeout, now + kLoraTransmissionTimeout);
+}
+
+// The local link manager in charge of the data rate and TX power, without the
+// network ADR, which would fight it (see link.hpp). The link check keeps the
+// back-off to slower data rates when the network stays silent.
+void ConfigureMac() {
+    LMIC_setAdrMode(0);
+    LMIC_setLinkCheckMode(1);
+    LMIC_setDrTxpow(linkManager.DataRate(), linkManager.TxPower());
+}
+
+// Reset the MAC, keeping the session (keys and frame counters)
+void ResetMac() {
+    PersistentState state;
+    SaveSession(&state);
+    LMIC_reset();
+    if (state.joined) {
+        RestoreSession(state);
+    }
+    ConfigureMac();
+    classB.Reset();
+}
+
+// Apply the decision of the Class B manager. The network learns of the
+// change from the next uplink: the ping slot request that LMIC adds to it,
+// or its Class B bit cleared.
+void UpdateClassB(uint32_t now) {
+    if (LMIC.devaddr == 0 || (LMIC.opmode & OP_JOINING) != 0) {
+        return;  // ping slots need a session
+    }
+    uint16_t vbat                = battery.Average();
+    ClassBManager::Action action = classB.Update(now, vbat);
+    switch (action) {
+        case ClassBManager::kScan:
+            // Continuous reception until a beacon, up to a beacon period
+            Profile.Start(Profiler::kRadio);
+            LMIC_enableTracking(0);
+            break;
+
+        case ClassBManager::kPing:
+            LMIC_setPingable(classB.Periodicity());
+            uplinkPolicy.Request();
+            break;
+
+        case ClassBManager::kStop:
+            Profile.Stop(Profiler::kRadio);  // if still scanning
+            LMIC_stopPingable();
+            LMIC_disableTracking();
+            uplinkPolicy.Request();
+            break;
+
+        default:
+            break;
+    }
+    if (classB.GetMode() == ClassBManager::kWaiting) {
+        scheduler.At(kTimerClassB, classB.RetryAt());
+    } else {
+        scheduler.Cancel(kTimerClassB);
+    }
+    if (action == ClassBManager::kKeep) {
+        return;
+    }
+    TRACE(ClassBAction, action, classB.Periodicity(), vbat);
+    if (action == ClassBManager::kStop &&
+        classB.GetMode() == ClassBManager::kWaiting) {
+        TRACE(ClassBFallback, classB.RetryAt());
+    }
+}
+
+// Staged recovery from a transmission timeout: cancel and retry later,
+// reset the MAC, and reset the chip as a last resort. The data of the
+// failed uplink is still in the telemetry buffer and is sent again.
+void RecoverTransmission(uint32_t now) {
+    TxRecovery::Stage stage = txRecovery.OnTimeout();
+    TRACE(TxTimeout, stage, txRecovery.Count(stage));
+    Profile.Stop(Profiler::kRadio);
+    if ((LMIC.opmode & OP_JOINING) != 0 && stage == TxRecovery::kRetry) {
+        ResetMac();  // a join cannot be cancelled otherwise
+    }
+    LMIC_clrTxData();
+    loraTransmission = false;
+    stateDirty       = true;
+
+    switch (stage) {
+        case TxRecovery::kRetry:
+            linkManager.OnFailure();
+            LMIC_setDrTxpow(linkManager.DataRate(), linkManager.TxPower());
+            break;
+
+        case TxRecovery::kMacReset:
+            ResetMac();
+            break;
+
+        case TxRecovery::kChipReset:
+            SaveState();  // keep the session and the valves
+            WatchdogReset();
+            break;
+
+        default:
+            break;
+    }
+
+    uint32_t backoff = txRecovery.Backoff();
+    TRACE(NextAttempt, backoff);
+    uplinkPolicy.Request();
+    uplinkPolicy.Backoff(now + backoff);
 }
 
 void setup() {
+    Memory.Begin();  // before anything else uses the stack or the heap
     delay(1000);  // Wait 1 seconds for the serial to be available - NOLINT
     pinMode(kLedPin, OUTPUT);
     digitalWrite(kLedPin, LOW);
 
     Serial.begin(115200);
-    Log.begin(LOG_LEVEL_VERBOSE, &Serial);
-    Log.infoln("Starting");
+    Trace.Begin(&Serial);
+    TRACE(Starting);
+    Profile.Begin();
+    Profile.Start(Profiler::kAwake);
 
-    rtc.begin(true);
-    for (int i = 0; i < nOfValves; i++) {
-        valves[i] = new Valve(i, &rtc, kValvePins[i][0], kValvePins[i][1]);
-    }
+    rtc.begin(false);  // keep the time across a system reset
+    Sleep.Begin(&rtc);
+    battery.Begin();
+    Pulses.Begin(&coils);
+    valves.Begin();
 
-    Log.infoln("Closing all valves");
-    for (int i = 0; i < nOfValves; i++) {
-        valves[i]->Close(true);
+    if (PM->RCAUSE.bit.WDT != 0) {
+        TRACE(ResetByWatchdog);
     }
+    WatchdogBegin();
+    // Jitter of the retries, different on every device
+    uint32_t seed;
+    memcpy_P(&seed, kDevEUI, sizeof(seed));
+    randomSeed(seed ^ rtc.getY2kEpoch());
 
     // LMIC init
     os_init();
     // Reset the MAC state. Session and pending data transfers will be
     // discarded.
     LMIC_reset();
+    RestoreState();
 
-    LMIC_setLinkCheckMode(0);
-    LMIC_setDrTxpow(DR_SF7, 14);  // NOLINT
+    TRACE(ClosingOthers);
+    valves.Close(~valves.OpenMask() & Valves::kAll, true);
+
+    ConfigureMac();
 
     loraTransmission = false;
-    lastTransmission = rtc.getY2kEpoch() - kSendInterval;
+    scheduler.At(kTimerSample, rtc.getY2kEpoch() + kSampleInterval);
 }
 
-void loop() {
-    static bool first = true;
-    uint32_t now      = rtc.getY2kEpoch();  // NOLINT
+void LogStatus(uint32_t now) { TRACE(Status, now, ValvesStatus()); }
 
-    if (loraTransmission &&
-        (now - lastTransmission > kLoraTransmissionTimeout)) {
-        Log.errorln("Transmission timeout... reseting the system");
-        NVIC_SystemReset();  // Reset the system
+void OnTimer(int id, uint32_t now) {
+    if (id >= 0 && id < nOfValves) {
+        CloseValve(id, Telemetry::kTimeout);
         return;
     }
+    switch (id) {
+        case kTimerTxTimeout:
+            RecoverTransmission(now);
+            break;
 
-    if (loraTransmission) {
-        // Still transmitting... be silent
+        case kTimerSample:
+            scheduler.At(kTimerSample, now + kSampleInterval);
+            battery.Voltage();
+            telemetry.AddSample(now, battery.Average(), ValvesStatus());
+            break;
+
+        case kTimerUplink:
+            // The uplink policy is checked by the main loop
+            break;
+
+        case kTimerSchedule:
+            RunSchedule(now);
+            break;
+
+        case kTimerClassB:
+            // The next beacon scan is started by the main loop
+            break;
+
+        default:
+            break;
+    }
+}
+
+void loop() {
+    WatchdogFeed();
+    uint32_t now = rtc.getY2kEpoch();  // NOLINT
+
+    Pulses.Poll();
+    Trace.Drain();
+
+    int id = scheduler.PopExpired(now);
+    while (id != Scheduler::kNoTimer) {
+        OnTimer(id, now);
+        id = scheduler.PopExpired(now);
+    }
+    RunCommands();
+
+    if (loraTransmission || Pulses.Busy() || (LMIC.opmode & OP_SCAN) != 0) {
+        // Still transmitting, pulsing a coil or scanning for a beacon... be
+        // silent. The pulse engine timer does not run in deep sleep, but
+        // wakes the MCU from idle, as the radio does.
         os_runloop_once();
+        DeepSleep::Idle();
         return;
     }
 
     digitalWrite(kLedPin, HIGH);
-    if (first || (now - lastTransmission > kSendInterval)) {
-        Log.infoln("Sending voltage");
-        loraTransmission = true;
-        first            = false;
-        SendLoraPacket();
-        lastTransmission = now;
+    LogStatus(now);
+    CheckUplink(now);
+    if (loraTransmission) {
         return;
     }
-
-    char buf[64];   // NOLINT
-    char* p = buf;  // NOLINT
-
-    // cppcheck-suppress invalidPrintfArgType_uint
-    p += snprintf(buf, sizeof(buf) - (p - buf), "%010lu", now);
-    for (int i = 0; i < nOfValves; i++) {
-        p += snprintf(p,
-                      sizeof(buf) - (p - buf),
-                      " %d:%c",
-                      i,
-                      valves[i]->IsOpen() ? 'O' : 'X');
+    UpdateClassB(now);
+    if ((LMIC.opmode & OP_SCAN) != 0) {
+        return;
+    }
+    if (stateDirty) {
+        SaveState();
     }
 
-    Log.infoln("Loop : @%s", buf);
+    // Sleep until the earliest deadline. The RTC has a resolution of one
+    // second, so deadlines are met within a second.
+    uint32_t sleep = kMaxSleep;
+    uint32_t next  = scheduler.Next();
+    if (next != Scheduler::kNever) {
+        uint32_t remaining = next - rtc.getY2kEpoch();
+        if (static_cast<int32_t>(remaining) <= 0) {
+            return;
+        }
+        if (remaining < sleep) {
+            sleep = remaining;
+        }
+    }
 
-    for (int i = 0; i < nOfValves; i++) {
-        valves[i]->LoopOnce();
+    // Wake up in time for the LMIC jobs (receive windows, join backoff,
+    // beacons and ping slots)
+    sleep = DeepSleep::Limit(sleep);
+    if (sleep == 0) {
+        os_runloop_once();
+        DeepSleep::Idle();
+        return;
     }
-    digitalWrite(kLedPin, LOW);
 
-#ifdef LOW_POWER
-    LowPower.deepSleep(kLoopSleep * 1000);  // NOLINT
-#else
-    delay(kLoopSleep * 1000);  // NOLINT
-#endif
+    Trace.Drain();
+    digitalWrite(kLedPin, LOW);
+    Profile.Stop(Profiler::kAwake);
+    uint32_t slept = Sleep.For(sleep);
+    Profile.Add(Profiler::kSleep, slept);
+    Profile.Start(Profiler::kAwake);
 }
@@ -0,0 +1,2 @@
+// The batch decoder of the backend is not a library: build it with the tests
+#include "../../host/telemetry_batch.cpp"
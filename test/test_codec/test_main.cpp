@@ -0,0 +1,606 @@
+/**
+ ******************************************************************************
+ * @file        : test_main.cpp
+ * @brief       : Tests of the frame codecs and of the README formatters
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * The codecs are checked against reference implementations that follow the
+ * formatters of README.md line by line, with the arithmetic of JavaScript:
+ * random command lists go through encodeDownlink(), DownlinkWriter and
+ * Payload, random record streams through Telemetry, decodeTelemetry() and
+ * DecodeTelemetry(), and random valve statistics through ValveStatsWriter,
+ * decodeValveStats() and ValveStatsReader. Truncated, oversized, mutated
+ * and random downlinks must be rejected as a whole or yield commands that
+ * stay inside the frame.
+ *
+ * Run with: pio test -e native -f test_codec
+ ******************************************************************************
+ */
+
+#include <Arduino.h>
+#include <math.h>
+#include <unity.h>
+
+#include <vector>
+
+#include "payload.hpp"
+#include "telemetry.hpp"
+#include "telemetry_batch.hpp"
+
+static const uint32_t kSeed    = 0x2023;
+static const int kRandomFrames = 200000;
+
+// Fail the test, with a message formatted only then
+#define CHECK(condition, ...)                                               \
+    do {                                                                    \
+        if (!(condition)) {                                                 \
+            char message[160];                                              \
+            snprintf(message, sizeof(message), __VA_ARGS__);                \
+            TEST_FAIL_MESSAGE(message);                                     \
+        }                                                                   \
+    } while (0)
+
+// xorshift32, so that the runs are reproducible on every host
+class Random {
+   public:
+    explicit Random(uint32_t seed) : state_(seed) {}
+    uint32_t Next() {
+        state_ ^= state_ << 13;  // NOLINT
+        state_ ^= state_ >> 17;  // NOLINT
+        state_ ^= state_ << 5;   // NOLINT
+        return state_;
+    }
+    uint32_t Below(uint32_t n) { return Next() % n; }
+
+   private:
+    uint32_t state_;
+};
+
+// ---------------------------------------------------------------------------
+// Reference codecs, as in README.md
+// ---------------------------------------------------------------------------
+
+using Bytes = std::vector<uint8_t>;
+
+// The shifts of JavaScript convert their operands to 32-bit integers: `<<`
+// gives a signed result (1 << 31 is negative), `>>>` an unsigned one
+static uint32_t ToUint32(double value) {
+    return static_cast<uint32_t>(static_cast<int64_t>(value));
+}
+static int32_t JsShl(double a, int b) {
+    return static_cast<int32_t>(ToUint32(a) << (b & 31));  // NOLINT
+}
+static uint32_t JsUshr(double a, int b) {
+    return ToUint32(a) >> (b & 31);  // NOLINT
+}
+
+static void PutLE(Bytes* bytes, uint32_t value, int n) {
+    for (int i = 0; i < n; i++) {
+        bytes->push_back(value & 0xFF);  // NOLINT
+        value >>= 8;                     // NOLINT
+    }
+}
+
+// encodeDownlink()
+static Bytes EncodeDownlink(const std::vector<Command>& commands) {
+    Bytes bytes = {Payload::kVersion};
+    for (const Command& c : commands) {
+        Bytes value;
+        switch (c.opcode) {
+            case Command::kOpen:
+                value.push_back(c.valve);
+                PutLE(&value, c.value, 4);
+                break;
+            case Command::kClose:
+                value.push_back(c.valve);
+                break;
+            case Command::kQuery:
+            case Command::kSetClassB:
+                value.push_back(c.value);
+                break;
+            case Command::kSequence:
+                PutLE(&value, c.value, 2);
+                break;
+            default:
+                PutLE(&value, c.value, 4);
+                break;
+        }
+        bytes.push_back(c.opcode);
+        bytes.push_back(value.size());
+        bytes.insert(bytes.end(), value.begin(), value.end());
+    }
+    return bytes;
+}
+
+struct Decoded {
+    int kind;
+    uint32_t age;
+    int32_t millivolts;
+    uint32_t valves;
+    int valve;
+};
+
+// decodeTelemetry()
+class TelemetryDecoder {
+   public:
+    explicit TelemetryDecoder(const Bytes& bytes) : bytes_(bytes), pos_(64) {}
+
+    std::vector<Decoded> Decode() {
+        uint32_t now = 0;
+        for (int i = 4; i >= 1; i--) {
+            now = now << 8 | bytes_[i];  // NOLINT
+        }
+        int count     = bytes_[5];  // NOLINT
+        int nOfValves = bytes_[6];  // NOLINT
+        std::vector<Decoded> records;
+        uint32_t t      = now;
+        int32_t voltage = 0;
+        double valves   = 0;
+        for (int n = 0; n < count; n++) {
+            Decoded record = {};
+            record.kind    = Bits(2);
+            uint32_t dt    = Varbits(6);  // NOLINT
+            t              = n == 0 ? now - dt : t + dt;
+            record.age     = now - t;
+            if (record.kind == Telemetry::kSample) {
+                voltage += SignedVarbits(3);
+                if (Bits(1) != 0) {
+                    valves = Bits(nOfValves);
+                }
+                record.millivolts = voltage;
+                for (int i = 0; i < nOfValves; i++) {
+                    record.valves |= (JsUshr(valves, i) & 1) << i;
+                }
+            } else {
+                record.valve = Bits(5);  // NOLINT
+            }
+            records.push_back(record);
+        }
+        return records;
+    }
+
+    // Offset of the valve statistics, after the records
+    int End() const { return (pos_ + 7) / 8; }  // NOLINT
+
+   private:
+    uint32_t Bits(int n) {
+        uint32_t v = 0;
+        for (int i = 0; i < n; i++, pos_++) {
+            int bit = bytes_[pos_ / 8] >> (7 - pos_ % 8) & 1;  // NOLINT
+            v       = v << 1 | bit;
+        }
+        return v;
+    }
+    uint32_t Varbits(int chunk) {
+        double v      = 0;
+        double shift  = 1;
+        uint32_t more = 0;
+        do {
+            more = Bits(1);
+            v += Bits(chunk) * shift;
+            shift *= JsShl(1, chunk);
+        } while (more != 0);
+        return ToUint32(v);
+    }
+    int32_t SignedVarbits(int chunk) {
+        uint32_t z = Varbits(chunk);
+        return static_cast<int32_t>(z >> 1) ^ -static_cast<int32_t>(z & 1);
+    }
+
+    const Bytes& bytes_;
+    int pos_;  // bits
+};
+
+// decodeValveStats()
+static std::vector<std::pair<int, ValveStats>> DecodeValveStats(
+    const Bytes& bytes, size_t pos, uint32_t now) {
+    auto varint = [&]() {
+        double v     = 0;
+        double shift = 1;
+        uint8_t b    = 0;
+        do {
+            b = bytes[pos++];
+            v += (b & 0x7F) * shift;  // NOLINT
+            shift *= 128;             // NOLINT
+        } while ((b & 0x80) != 0);    // NOLINT
+        return ToUint32(v);
+    };
+    double mask = varint();
+    std::vector<std::pair<int, ValveStats>> result;
+    for (int i = 0; i < 32; i++) {  // NOLINT
+        if (fmod(floor(mask / pow(2, i)), 2) == 0) {
+            continue;
+        }
+        ValveStats s   = {};
+        s.openSeconds  = varint();
+        s.actuations   = varint();
+        s.failedCloses = varint();
+        s.forcedCloses = varint();
+        uint32_t age   = varint();
+        s.lastChange   = age == 0 ? 0 : now - (age - 1);
+        result.emplace_back(i, s);
+    }
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+// Tests
+// ---------------------------------------------------------------------------
+
+static Command RandomCommand(Random* random) {
+    static const uint8_t kOpcodes[] = {
+        Command::kOpen,     Command::kClose,    Command::kSetUplinkInterval,
+        Command::kQuery,    Command::kSetTime,  Command::kSequence,
+        Command::kSetClassB};
+    Command c = {};
+    c.opcode  = kOpcodes[random->Below(sizeof(kOpcodes))];
+    switch (c.opcode) {
+        case Command::kOpen:
+            c.valve = random->Below(32);  // NOLINT
+            c.value = random->Next();
+            break;
+        case Command::kClose:
+            c.valve = random->Below(32);  // NOLINT
+            break;
+        case Command::kQuery:
+            c.value = random->Below(2);
+            break;
+        case Command::kSequence:
+            c.value = random->Below(1 << 16);  // NOLINT
+            break;
+        case Command::kSetClassB:
+            c.value = random->Below(256);  // NOLINT
+            break;
+        default:
+            c.value = random->Next();
+            break;
+    }
+    return c;
+}
+
+void test_downlink_round_trip() {
+    Random random(kSeed);
+    for (int i = 0; i < kRandomFrames / 10; i++) {  // NOLINT
+        std::vector<Command> sent(random.Below(8));  // NOLINT
+        for (Command& c : sent) {
+            c = RandomCommand(&random);
+        }
+        Bytes frame = EncodeDownlink(sent);
+        Payload payload(frame.data(), frame.size());
+        CHECK(payload.IsValid() && !payload.IsLegacy(), "frame %d", i);
+
+        uint8_t written[64];  // NOLINT
+        DownlinkWriter writer(written, sizeof(written));
+        for (const Command& c : sent) {
+            switch (c.opcode) {
+                case Command::kOpen:
+                    writer.Open(c.valve, c.value);
+                    break;
+                case Command::kClose:
+                    writer.Close(c.valve);
+                    break;
+                case Command::kSetUplinkInterval:
+                    writer.SetUplinkInterval(c.value);
+                    break;
+                case Command::kQuery:
+                    writer.Query(c.value);
+                    break;
+                case Command::kSequence:
+                    writer.Sequence(c.value);
+                    break;
+                case Command::kSetClassB:
+                    writer.SetClassB(c.value);
+                    break;
+                default:
+                    writer.SetTime(c.value);
+                    break;
+            }
+        }
+        CHECK(Bytes(written, written + writer.Length()) == frame,
+              "frame %d: DownlinkWriter differs", i);
+
+        Command c;
+        size_t n = 0;
+        while (payload.Next(&c)) {
+            CHECK(n < sent.size(), "frame %d: extra command", i);
+            if (n >= sent.size()) {
+                break;
+            }
+            CHECK(c.opcode == sent[n].opcode && c.valve == sent[n].valve &&
+                      c.value == sent[n].value,
+                  "frame %d, command %zu: %02x %u %u", i, n, c.opcode,
+                  c.valve, c.value);
+            n++;
+        }
+        CHECK(n == sent.size(), "frame %d: %zu commands", i, n);
+    }
+}
+
+// decodeDownlink(): one nibble per valve, high nibble first
+void test_legacy() {
+    static const int kPeriods[] = {0,  4,  6,  8,  10, 12, 14, 16,
+                                   18, 20, 22, 24, 26, 28, -2, -1};
+    for (uint32_t value = 0; value < (1UL << 24); value++) {  // NOLINT
+        uint8_t frame[Payload::kLegacyLength];
+        for (int i = 0; i < Payload::kLegacyLength; i++) {
+            frame[i] = value >> (8 * i) & 0xFF;  // NOLINT
+        }
+        Payload payload(frame, sizeof(frame));
+        Command c;
+        int valve = 0;
+        while (payload.Next(&c)) {
+            for (; valve < c.valve; valve++) {
+                CHECK(payload.GetPeriod(valve) == 0, "%06x", value);
+            }
+            int nibble = frame[valve / 2] >> (valve % 2 == 0 ? 4 : 0) & 0xF;
+            int period = kPeriods[nibble];
+            CHECK(period != 0 && payload.GetPeriod(valve) == period,
+                  "%06x valve %d", value, valve);
+            if (period == -1) {
+                CHECK(c.opcode == Command::kClose, "%06x", value);
+            } else {
+                uint32_t seconds = period < 0 ? 0 : period * 60;  // NOLINT
+                CHECK(c.opcode == Command::kOpen && c.value == seconds, "%06x",
+                      value);
+            }
+            valve++;
+        }
+    }
+}
+
+// A frame must be rejected as a whole, or every command must lie inside it
+static int CheckFrame(const Bytes& frame) {
+    Payload payload(frame.data(), frame.size());
+    Command c;
+    int n = 0;
+    while (payload.Next(&c)) {
+        CHECK(payload.IsValid(), "command from an invalid frame");
+        if (c.data != nullptr) {
+            CHECK(c.data > frame.data() && c.len > 0 &&
+                      c.data + c.len <= frame.data() + frame.size(),
+                  "command outside of the frame");
+        }
+        n++;
+    }
+    return n;
+}
+
+void test_malformed() {
+    Random random(kSeed);
+    for (int i = 0; i < kRandomFrames / 10; i++) {  // NOLINT
+        std::vector<Command> sent(1 + random.Below(4));
+        for (Command& c : sent) {
+            c = RandomCommand(&random);
+        }
+        Bytes frame = EncodeDownlink(sent);
+
+        // Truncated: a frame cut inside a command is rejected, a frame cut
+        // between two commands carries the commands before the cut
+        size_t end  = 1;  // end of the last complete command
+        int carried = 0;
+        for (size_t len = 2; len < frame.size(); len++) {
+            if (len == end + 2 + frame[end + 1]) {
+                end = len;
+                carried++;
+            }
+            Bytes prefix(frame.begin(), frame.begin() + len);
+            if (len != Payload::kLegacyLength) {
+                CHECK(CheckFrame(prefix) == (len == end ? carried : 0),
+                      "truncated to %zu", len);
+            }
+        }
+
+        // Oversized: trailing garbage, or a length past the end
+        Bytes longer = frame;
+        longer.push_back(random.Below(256));  // NOLINT
+        CHECK(CheckFrame(longer) == 0, "one byte of garbage");
+        longer    = frame;
+        longer[2] = frame.size() - 2 + random.Below(200);  // NOLINT
+        CHECK(CheckFrame(longer) == 0, "length past the end");
+
+        // Bad version
+        frame[0] = Payload::kVersion + 1 + random.Below(254);  // NOLINT
+        CHECK(CheckFrame(frame) == 0 || frame.size() == 3, "bad version");
+    }
+
+    // Random and mutated frames, up to the maximum frame size
+    Bytes frame;
+    for (int i = 0; i < kRandomFrames; i++) {
+        frame.resize(random.Below(256));  // NOLINT
+        for (uint8_t& byte : frame) {
+            byte = random.Below(8) == 0 ? random.Below(256) : 1;  // NOLINT
+        }
+        CheckFrame(frame);
+    }
+}
+
+// The batch decoder must agree with decodeTelemetry()
+static void CheckBatch(const Bytes& frame, const Decoded* expected) {
+    TelemetryColumns columns;
+    TelemetryFrame batch = {frame.data(), static_cast<int>(frame.size())};
+    CHECK(DecodeTelemetry(&batch, 1, &columns) == 0, "batch rejected");
+    uint32_t now    = DownlinkFormat::ReadLE(frame.data() + 1, 4);
+    uint32_t valves = 0;
+    for (size_t i = 0; i < columns.Size(); i++) {
+        const Decoded& want = expected[i];
+        if (want.kind == Telemetry::kSample) {
+            valves = want.valves;
+        }
+        CHECK(columns.kind[i] == want.kind &&
+                  columns.time[i] == now - want.age &&
+                  columns.millivolts[i] == want.millivolts &&
+                  columns.valve[i] == want.valve,
+              "batch record %zu", i);
+        for (int v = 0; v < TelemetryColumns::kMaxValves; v++) {
+            uint32_t open = columns.open[i * TelemetryColumns::kMaxValves + v];
+            CHECK(open == ((valves >> v) & 1), "batch record %zu valve %d", i,
+                  v);
+        }
+    }
+    CHECK(columns.Size() == frame[5], "batch: %zu records", columns.Size());
+}
+
+void test_telemetry() {
+    Random random(kSeed);
+    for (int i = 0; i < kRandomFrames / 100; i++) {  // NOLINT
+        int nOfValves = 1 + random.Below(32);  // NOLINT
+        Telemetry telemetry(nOfValves);
+        std::vector<Decoded> expected;
+        uint32_t now = random.Next();
+        int count    = 1 + random.Below(Telemetry::kCapacity);
+        uint32_t t   = now - count * 5000;  // NOLINT
+        for (int n = 0; n < count; n++) {
+            t += random.Below(5000);  // NOLINT
+            Decoded record = {};
+            record.age     = now - t;
+            if (random.Below(2) == 0) {
+                record.kind       = Telemetry::kSample;
+                record.millivolts = 3000 + random.Below(1300);  // NOLINT
+                record.valves     = random.Next() >> (32 - nOfValves);
+                telemetry.AddSample(t, record.millivolts, record.valves);
+            } else {
+                record.kind  = 1 + random.Below(3);
+                record.valve = random.Below(nOfValves);
+                telemetry.AddEvent(t, static_cast<Telemetry::Kind>(record.kind),
+                                   record.valve);
+            }
+            expected.push_back(record);
+        }
+
+        // Drain the buffer in frames of random size, from SF12 to SF7
+        size_t next = 0;
+        while (telemetry.Size() > 0) {
+            Bytes frame(43 + random.Below(180));  // NOLINT
+            int len = telemetry.Encode(now, frame.data(), frame.size());
+            CHECK(len > Telemetry::kHeaderSize &&
+                      len <= static_cast<int>(frame.size()),
+                  "frame length %d", len);
+            frame.resize(len);
+            CheckBatch(frame, expected.data() + next);
+            for (const Decoded& record : TelemetryDecoder(frame).Decode()) {
+                Decoded want = expected[next++];
+                CHECK(record.kind == want.kind && record.age == want.age,
+                      "record %zu: kind %d age %u", next, record.kind,
+                      record.age);
+                CHECK(want.kind != Telemetry::kSample ||
+                          (record.millivolts == want.millivolts &&
+                           record.valves == want.valves),
+                      "record %zu: %d mV, valves %x", next,
+                      record.millivolts, record.valves);
+                CHECK(want.kind == Telemetry::kSample ||
+                          record.valve == want.valve,
+                      "record %zu: valve %d", next, record.valve);
+            }
+            telemetry.Commit();
+        }
+        CHECK(next == expected.size(), "%zu records decoded", next);
+    }
+}
+
+// The last of 32 valves, where a signed shift of JavaScript goes wrong
+void test_valve_31() {
+    Telemetry telemetry(32);                         // NOLINT
+    telemetry.AddSample(1000, 3700, 0x80000001UL);  // NOLINT
+    Bytes frame(51);                                 // NOLINT
+    frame.resize(telemetry.Encode(1000, frame.data(), frame.size()));
+    std::vector<Decoded> records = TelemetryDecoder(frame).Decode();
+    CHECK(records.size() == 1 && records[0].valves == 0x80000001UL,
+          "valves %x", records.empty() ? 0 : records[0].valves);
+}
+
+static bool operator==(const ValveStats& a, const ValveStats& b) {
+    return a.openSeconds == b.openSeconds && a.lastChange == b.lastChange &&
+           a.actuations == b.actuations && a.failedCloses == b.failedCloses &&
+           a.forcedCloses == b.forcedCloses;
+}
+
+// Blocks appended to telemetry frames, and frames on their own
+void test_valve_stats() {
+    Random random(kSeed);
+    for (int i = 0; i < kRandomFrames / 100; i++) {  // NOLINT
+        uint32_t now = random.Next();
+        ValveStats stats[ValveStatsFormat::kMaxValves];
+        for (ValveStats& s : stats) {
+            s.openSeconds  = random.Next() >> random.Below(32);  // NOLINT
+            s.actuations   = random.Next() >> random.Below(16);  // NOLINT
+            s.failedCloses = random.Below(4);
+            s.forcedCloses = random.Below(4);
+            s.lastChange   = now - random.Below(1000000);  // NOLINT
+            if (random.Below(4) == 0) {
+                s.lastChange = 0;
+            }
+        }
+        uint32_t mask = random.Next() & random.Next();
+
+        Telemetry telemetry(8);  // NOLINT
+        telemetry.AddSample(now - 10, 3700, 0x5A);  // NOLINT
+        telemetry.AddEvent(now - 5, Telemetry::kOpened, 3);  // NOLINT
+        Bytes frame(51 + random.Below(172));  // NOLINT
+        int len = telemetry.Encode(now, frame.data(), frame.size());
+        int n   = ValveStatsWriter::Encode(
+            frame.data() + len, frame.size() - len, now, mask, stats);
+        if (n == 0) {
+            continue;  // does not fit, not appended
+        }
+        frame.resize(len + n);
+
+        TelemetryDecoder decoder(frame);
+        decoder.Decode();
+        CHECK(decoder.End() == len, "frame %d: block at %d", i, decoder.End());
+        TelemetryReader reader(frame.data(), frame.size());
+        TelemetryRecord record;
+        while (reader.Next(&record)) {
+        }
+        CHECK(reader.Length() == len, "frame %d: length %d", i,
+              reader.Length());
+
+        auto decoded = DecodeValveStats(frame, len, now);
+        ValveStatsReader stream(frame.data() + len, n, now);
+        CHECK(stream.Mask() == mask, "frame %d: mask %x", i, stream.Mask());
+        size_t k = 0;
+        int valve;
+        ValveStats s;
+        while (stream.Next(&valve, &s)) {
+            CHECK(k < decoded.size() && decoded[k].first == valve &&
+                      decoded[k].second == s && s == stats[valve],
+                  "frame %d: valve %d", i, valve);
+            k++;
+        }
+        CHECK(stream.IsValid() && stream.Length() == n &&
+                  k == decoded.size() &&
+                  static_cast<int>(k) == __builtin_popcount(mask),
+              "frame %d: %zu valves", i, k);
+
+        // On their own port, with the header
+        Bytes own(ValveStatsFormat::kHeaderSize + n);
+        int size = own.size();
+        CHECK(ValveStatsWriter::EncodeFrame(
+                  own.data(), size, now, mask, stats) == size,
+              "frame %d: EncodeFrame", i);
+        CHECK(ValveStatsWriter::EncodeFrame(
+                  own.data(), size - 1, now, mask, stats) == 0,
+              "frame %d: EncodeFrame overflow", i);
+    }
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+int main(int /* argc */, char** /* argv */) {
+    UNITY_BEGIN();
+    RUN_TEST(test_legacy);
+    RUN_TEST(test_downlink_round_trip);
+    RUN_TEST(test_malformed);
+    RUN_TEST(test_telemetry);
+    RUN_TEST(test_valve_31);
+    RUN_TEST(test_valve_stats);
+    return UNITY_END();
+}
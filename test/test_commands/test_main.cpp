@@ -0,0 +1,71 @@
+/**
+ ******************************************************************************
+ * @file        : test_main.cpp
+ * @brief       : Tests of the downlink command queue
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Tests of the replay protection of CommandQueue: sequence numbers must be
+ * newer than the last one accepted, in 16-bit serial arithmetic, 0 included.
+ *
+ * Run with: pio test -e native -f test_commands
+ ******************************************************************************
+ */
+
+#include <unity.h>
+
+#include "commands.hpp"
+
+void test_first_sequence() {
+    CommandQueue queue;
+    TEST_ASSERT_FALSE(queue.HasSequence());
+    TEST_ASSERT_TRUE(queue.Accept(1234));  // NOLINT
+    TEST_ASSERT_TRUE(queue.HasSequence());
+    TEST_ASSERT_EQUAL_UINT16(1234, queue.Sequence());
+}
+
+void test_replay() {
+    CommandQueue queue;
+    TEST_ASSERT_TRUE(queue.Accept(10));   // NOLINT
+    TEST_ASSERT_FALSE(queue.Accept(10));  // NOLINT
+    TEST_ASSERT_FALSE(queue.Accept(9));   // NOLINT
+    TEST_ASSERT_TRUE(queue.Accept(11));   // NOLINT
+    TEST_ASSERT_EQUAL_UINT16(11, queue.Sequence());
+}
+
+void test_sequence_zero() {
+    CommandQueue queue;
+    TEST_ASSERT_TRUE(queue.Accept(0));
+    TEST_ASSERT_FALSE(queue.Accept(0));  // a replay of frame 0
+    TEST_ASSERT_TRUE(queue.Accept(5));   // NOLINT
+    TEST_ASSERT_FALSE(queue.Accept(0));  // no restart
+    TEST_ASSERT_EQUAL_UINT16(5, queue.Sequence());
+}
+
+void test_wrap() {
+    CommandQueue queue;
+    queue.Restore(65535);  // NOLINT
+    TEST_ASSERT_TRUE(queue.Accept(0));
+    TEST_ASSERT_TRUE(queue.Accept(32767));   // NOLINT: the farthest ahead
+    TEST_ASSERT_FALSE(queue.Accept(0));      // NOLINT: now behind
+    TEST_ASSERT_FALSE(queue.Accept(65535));  // NOLINT
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+int main(int /* argc */, char** /* argv */) {
+    UNITY_BEGIN();
+    RUN_TEST(test_first_sequence);
+    RUN_TEST(test_replay);
+    RUN_TEST(test_sequence_zero);
+    RUN_TEST(test_wrap);
+    return UNITY_END();
+}
@@ -0,0 +1,200 @@
+/**
+ ******************************************************************************
+ * @file        : test_main.cpp
+ * @brief       : Tests of the bus coil outputs
+ * @author      : Jacques Supcik <jacques.supcik@hefr.ch>
+ * @date        : 17 October 2026
+ ******************************************************************************
+ * @copyright   : Copyright (c) 2023 HEIA-FR / ISC
+ *                Haute école d'ingénierie et d'architecture de Fribourg
+ *                Informatique et Systèmes de Communication
+ * @attention   : SPDX-License-Identifier: MIT OR Apache-2.0
+ ******************************************************************************
+ * @details
+ * Tests of ShiftRegisterOutput and Mcp23017Output against recording mock
+ * buses: the bytes shifted out and the latch pulse of a flush, and the
+ * register writes of the MCP23017 (IODIR after OLAT at init, then OLAT
+ * pairs), for a few line patterns. The pins and the interrupt mask are
+ * mocked here as well, as the tests do not link the simulator.
+ *
+ * Run with: pio test -e native -f test_output
+ ******************************************************************************
+ */
+
+#include <unity.h>
+
+#include <vector>
+
+#include "mcp23017_output.hpp"
+#include "shift_register_output.hpp"
+
+// One step on a bus or a pin, in the order they happen
+struct Step {
+    enum Kind { kBegin, kTransaction, kByte, kEnd, kPin, kAddress };
+
+    Kind kind;
+    int value;
+
+    bool operator==(const Step& other) const {
+        return kind == other.kind && value == other.value;
+    }
+};
+
+using Steps = std::vector<Step>;
+
+static Steps steps;  // NOLINT(*-global-variables)
+
+static const int kLatchPin = 12;
+
+void pinMode(int /* pin */, int /* mode */) {}
+
+void digitalWrite(int pin, int value) {
+    steps.push_back({Step::kPin, pin << 1 | value});
+}
+
+uint32_t __get_PRIMASK() { return 0; }
+void __set_PRIMASK(uint32_t /* primask */) {}
+void __disable_irq() {}
+
+class MockSpi {
+   public:
+    void begin() { steps.push_back({Step::kBegin, 0}); }
+    void beginTransaction(SPISettings /* settings */) {
+        steps.push_back({Step::kTransaction, 0});
+    }
+    uint8_t transfer(uint8_t data) {
+        steps.push_back({Step::kByte, data});
+        return 0;
+    }
+    void endTransaction() { steps.push_back({Step::kEnd, 0}); }
+};
+
+class MockWire {
+   public:
+    void begin() { steps.push_back({Step::kBegin, 0}); }
+    void beginTransmission(uint8_t address) {
+        steps.push_back({Step::kAddress, address});
+    }
+    size_t write(uint8_t data) {
+        steps.push_back({Step::kByte, data});
+        return 1;
+    }
+    uint8_t endTransmission() {
+        steps.push_back({Step::kEnd, 0});
+        return nack ? 2 : 0;  // NOLINT
+    }
+
+    bool nack = false;
+};
+
+static void Expect(const char* what, const Steps& expected) {
+    if (steps == expected) {
+        steps.clear();
+        return;
+    }
+    char message[256];  // NOLINT
+    int len = snprintf(message, sizeof(message), "%s: got", what);
+    for (const Step& step : steps) {
+        if (len < static_cast<int>(sizeof(message))) {
+            len += snprintf(message + len, sizeof(message) - len, " %d:%02x",
+                            step.kind, step.value);
+        }
+    }
+    steps.clear();
+    TEST_FAIL_MESSAGE(message);
+}
+
+// A flush of the shift registers: the last chip first, then a latch pulse
+static Steps Shifted(const std::vector<uint8_t>& bytes) {
+    Steps expected = {{Step::kTransaction, 0}};
+    for (uint8_t byte : bytes) {
+        expected.push_back({Step::kByte, byte});
+    }
+    expected.push_back({Step::kEnd, 0});
+    expected.push_back({Step::kPin, kLatchPin << 1 | HIGH});
+    expected.push_back({Step::kPin, kLatchPin << 1 | LOW});
+    return expected;
+}
+
+void test_shift_register() {
+    MockSpi spi;
+    ShiftRegisterOutput<MockSpi, 3> out(&spi, kLatchPin);
+    out.Begin();
+    Steps expected = {{Step::kPin, kLatchPin << 1 | LOW}, {Step::kBegin, 0}};
+    Steps flush    = Shifted({0x00, 0x00, 0x00});
+    expected.insert(expected.end(), flush.begin(), flush.end());
+    Expect("74HC595 begin", expected);
+
+    out.Set(0, true);
+    out.Set(9, true);   // NOLINT
+    out.Set(23, true);  // NOLINT
+    out.Set(24, true);  // NOLINT: no such line
+    steps.clear();      // Set() only changes the image
+    out.Flush();
+    Expect("74HC595 lines 0, 9, 23", Shifted({0x80, 0x02, 0x01}));
+
+    out.Set(9, false);  // NOLINT
+    out.Set(16, true);  // NOLINT
+    out.Flush();
+    Expect("74HC595 lines 0, 16, 23", Shifted({0x81, 0x00, 0x01}));
+
+    out.Clear();
+    out.Flush();
+    Expect("74HC595 cleared", Shifted({0x00, 0x00, 0x00}));
+}
+
+// A write of a register pair (A, then B) of one chip
+static void AddWrite(Steps* expected, int address, int reg, int a, int b) {
+    Steps write = {{Step::kAddress, address},
+                   {Step::kByte, reg},
+                   {Step::kByte, a},
+                   {Step::kByte, b},
+                   {Step::kEnd, 0}};
+    expected->insert(expected->end(), write.begin(), write.end());
+}
+
+void test_mcp23017() {
+    static const int kAddress = 0x24;
+    static const int kIodirA  = 0x00;
+    static const int kOlatA   = 0x14;
+
+    MockWire wire;
+    Mcp23017Output<MockWire, 2> out(&wire, kAddress);
+    out.Begin();
+    Steps expected = {{Step::kBegin, 0}};
+    for (int chip = 0; chip < 2; chip++) {
+        AddWrite(&expected, kAddress + chip, kOlatA, 0, 0);
+        AddWrite(&expected, kAddress + chip, kIodirA, 0, 0);
+    }
+    Expect("MCP23017 begin", expected);
+
+    out.Set(0, true);
+    out.Set(15, true);  // NOLINT
+    out.Set(17, true);  // NOLINT
+    out.Flush();
+    expected.clear();
+    AddWrite(&expected, kAddress, kOlatA, 0x01, 0x80);
+    AddWrite(&expected, kAddress + 1, kOlatA, 0x02, 0x00);
+    Expect("MCP23017 lines 0, 15, 17", expected);
+
+    out.Set(0, false);
+    out.Set(31, true);  // NOLINT
+    wire.nack = true;
+    out.Flush();
+    expected.clear();
+    AddWrite(&expected, kAddress, kOlatA, 0x00, 0x80);
+    AddWrite(&expected, kAddress + 1, kOlatA, 0x02, 0x80);
+    Expect("MCP23017 lines 15, 17, 31", expected);
+    TEST_ASSERT_EQUAL_INT(2, out.Failures());
+}
+
+void setUp() { steps.clear(); }
+
+void tearDown() {}
+
+int main(int /* argc */, char** /* argv */) {
+    UNITY_BEGIN();
+    RUN_TEST(test_shift_register);
+    RUN_TEST(test_mcp23017);
+    return UNITY_END();
+}
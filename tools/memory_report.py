@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+# RAM and flash used by each library, from the map file of the linker, and
+# checked against a budget.
+#
+# Usage: memory_report.py MAP [BUDGET]
+#
+# Flash holds the code, the constants and the initial values of .data; RAM
+# holds .data and .bss. The heap and the stack take the rest of the RAM at
+# run time (see lib/memory). The budget file has one line per limit,
+# "name ram flash" in bytes ("-" for no limit), where name is a library (the
+# name of its archive), "src" or "total". The exit status is 1 if a limit
+# is exceeded.
+#
+# Copyright (c) 2023 HEIA-FR / ISC
+# SPDX-License-Identifier: MIT OR Apache-2.0
+
+import os
+import re
+import sys
+
+RAM_ONLY = (".bss", ".noinit")
+RAM_AND_FLASH = (".data", ".relocate")
+RESERVED = (".heap", ".stack", ".stack_dummy")
+
+OUTPUT = re.compile(r"^(\.[\w.]+)\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)")
+INPUT = re.compile(r"^ (?:\.[\w.$]+|COMMON|\*fill\*)\s*$|"
+                   r"^ (\.[\w.$]+|COMMON|\*fill\*)\s+0x([0-9a-f]+)\s+"
+                   r"0x([0-9a-f]+)(?:\s+(.*))?$")
+WRAPPED = re.compile(r"^\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(.*)$")
+
+
+def owner(path):
+    if path is None:
+        return "(fill)"
+    match = re.search(r"lib([^/\\]+)\.a\(", path)
+    if match:
+        return match.group(1)
+    if re.search(r"[/\\]src[/\\]", path):
+        return "src"
+    return os.path.basename(path)
+
+
+def readMap(name):
+    usage = {}  # owner: [ram, flash]
+    section = None
+    pending = False
+    with open(name, "rt", errors="replace") as f:
+        lines = iter(f)
+        for line in lines:
+            if line.startswith("Linker script and memory map"):
+                break
+        for line in lines:
+            line = line.rstrip("\n")
+            match = OUTPUT.match(line)
+            if match:
+                address = int(match.group(2), 16)
+                section = match.group(1) if address != 0 else None
+                if section in RESERVED:
+                    section = None
+                pending = False
+                continue
+            if not line.startswith(" ") and line.strip():
+                section = None  # e.g. a debug section on two lines
+                continue
+            if section is None:
+                continue
+            size, path = None, None
+            match = INPUT.match(line)
+            if match and match.group(1) is None:
+                pending = True  # name alone, the rest is on the next line
+                continue
+            if match:
+                size, path = int(match.group(3), 16), match.group(4)
+            elif pending:
+                match = WRAPPED.match(line)
+                if match:
+                    size, path = int(match.group(2), 16), match.group(3)
+            pending = False
+            if not size:
+                continue
+            entry = usage.setdefault(owner(path), [0, 0])
+            if section in RAM_ONLY or section.startswith(".bss"):
+                entry[0] += size
+            elif section in RAM_AND_FLASH:
+                entry[0] += size
+                entry[1] += size
+            else:
+                entry[1] += size
+    return usage
+
+
+def readBudget(name):
+    budget = {}
+    with open(name, "rt") as f:
+        for line in f:
+            fields = line.split("#", 1)[0].split()
+            if not fields:
+                continue
+            if len(fields) != 3:
+                sys.exit("%s: bad line: %s" % (name, line.strip()))
+            budget[fields[0]] = [None if v == "-" else int(v, 0)
+                                 for v in fields[1:]]
+    return budget
+
+
+def main():
+    if len(sys.argv) not in (2, 3):
+        sys.exit("usage: %s MAP [BUDGET]" % sys.argv[0])
+    usage = readMap(sys.argv[1])
+    budget = readBudget(sys.argv[2]) if len(sys.argv) == 3 else {}
+
+    usage["total"] = [sum(v[0] for v in usage.values()),
+                      sum(v[1] for v in usage.values())]
+    names = sorted(usage, key=lambda n: (n == "total", -sum(usage[n])))
+    print("%-36s %8s %8s" % ("", "ram", "flash"))
+    over = []
+    for name in names:
+        ram, flash = usage[name]
+        limits = budget.get(name, [None, None])
+        marks = []
+        for kind, used, limit in zip(("ram", "flash"), (ram, flash), limits):
+            if limit is not None:
+                marks.append("%s %d%%" % (kind, 100 * used // limit))
+                if used > limit:
+                    over.append("%s: %s %d > %d" % (name, kind, used, limit))
+        row = "%-36s %8d %8d  %s" % (name[:36], ram, flash, ", ".join(marks))
+        print(row.rstrip())
+    for name in budget:
+        if name not in usage:
+            print("warning: %s is not in the map" % name, file=sys.stderr)
+    for line in over:
+        print("over budget: " + line, file=sys.stderr)
+    sys.exit(1 if over else 0)
+
+
+if __name__ == "__main__":
+    main()
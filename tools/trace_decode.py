@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+# Decode the binary trace written by lib/trace to the serial port.
+#
+# Usage: trace_decode.py [capture file or serial device]  (default: stdin)
+#
+# The event table and the enum names are read from the sources, so the
+# decoder must run on the same version of the tree as the firmware.
+#
+# Copyright (c) 2023 HEIA-FR / ISC
+# SPDX-License-Identifier: MIT OR Apache-2.0
+
+import glob
+import os
+import re
+import sys
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+EVENTS = os.path.join(ROOT, "lib", "trace", "trace_events.hpp")
+SYNC = 0xA5
+
+# LMIC events (lmic.h), numbered from 1
+LMIC_EVENTS = [
+    "EV_SCAN_TIMEOUT", "EV_BEACON_FOUND", "EV_BEACON_MISSED",
+    "EV_BEACON_TRACKED", "EV_JOINING", "EV_JOINED", "EV_RFU1",
+    "EV_JOIN_FAILED", "EV_REJOIN_FAILED", "EV_TXCOMPLETE", "EV_LOST_TSYNC",
+    "EV_RESET", "EV_RXCOMPLETE", "EV_LINK_DEAD", "EV_LINK_ALIVE",
+    "EV_SCAN_FOUND", "EV_TXSTART", "EV_TXCANCELED", "EV_RXSTART",
+    "EV_JOIN_TXCOMPLETE",
+]
+
+
+def readEvents():
+    with open(EVENTS, "rt") as f:
+        text = f.read()
+    table = text[text.index("#define TRACE_EVENTS(X)"):]
+    table = table.replace("\\\n", " ")
+    events = []
+    for name, level, fmt in re.findall(
+            r'X\(\s*(\w+)\s*,\s*(\w+)\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)', table):
+        events.append((name, level[1:].lower(), fmt))
+    return events
+
+
+def readEnums():
+    enums = {"ev_t": {i + 1: name for i, name in enumerate(LMIC_EVENTS)}}
+    for path in glob.glob(os.path.join(ROOT, "lib", "*", "*.hpp")):
+        with open(path, "rt") as f:
+            text = f.read()
+        for name, body in re.findall(r"enum\s+(\w+)[^{;]*\{([^}]*)\}", text):
+            values = {}
+            value = 0
+            for item in body.split(","):
+                item = re.sub(r"//.*", "", item).strip()
+                if not item:
+                    continue
+                if "=" in item:
+                    item, expr = [s.strip() for s in item.split("=", 1)]
+                    try:
+                        value = int(expr, 0)
+                    except ValueError:
+                        continue
+                values[value] = item[1:] if item.startswith("k") else item
+                value += 1
+            enums[name] = values
+    return enums
+
+
+def varint(data, pos):
+    value = 0
+    shift = 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if byte < 0x80:
+            return value, pos
+
+
+def formatEvent(fmt, args, enums):
+    args = list(args)
+
+    def arg(match):
+        spec = match.group(0)
+        if spec == "%%":
+            return "%"
+        value = args.pop(0) if args else 0
+        if match.group(2):
+            names = enums.get(match.group(2), {})
+            return names.get(value, str(value))
+        kind = match.group(1)[-1]
+        if kind == "d":
+            return ("%" + match.group(1)) % value
+        return ("%" + match.group(1)) % (value & 0xFFFFFFFF)
+
+    return re.sub(r"%%|%(\d*[dux])|%\{(\w+)\}", arg, fmt)
+
+
+def decode(stream, events, enums):
+    data = b""
+    time = 0
+    while True:
+        chunk = stream.read(1) if stream.isatty() else stream.read(4096)
+        if not chunk:
+            return
+        data += chunk
+        while True:
+            start = data.find(bytes([SYNC]))
+            if start < 0:
+                data = b""
+                break
+            data = data[start:]
+            if len(data) < 3 or len(data) < 3 + data[2]:
+                break
+            event, length = data[1], data[2]
+            payload = data[3:3 + length]
+            try:
+                fields = []
+                pos = 0
+                while pos < length:
+                    value, pos = varint(payload, pos)
+                    fields.append(value)
+                if pos != length or not fields or event >= len(events):
+                    raise ValueError
+            except (IndexError, ValueError):
+                data = data[1:]  # false sync, look for the next one
+                continue
+            data = data[3 + length:]
+            time += fields[0]
+            args = [(z >> 1) ^ -(z & 1) for z in fields[1:]]
+            name, level, fmt = events[event]
+            print("%10.3f %-7s %s" % (time / 1000, level.upper(),
+                                      formatEvent(fmt, args, enums)))
+            sys.stdout.flush()
+
+
+def main():
+    events = readEvents()
+    enums = readEnums()
+    if len(sys.argv) > 1:
+        with open(sys.argv[1], "rb", buffering=0) as f:
+            decode(f, events, enums)
+    else:
+        decode(sys.stdin.buffer, events, enums)
+
+
+if __name__ == "__main__":
+    main()